@@ -0,0 +1,34 @@
+/*
+ * Stand-in for the Arduino core in the host-native simulation build.
+ * Only what the node firmware uses.
+ */
+
+#ifndef _SIM_ARDUINO_H
+#define _SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/cpufunc.h>
+
+class HardwareSerial
+{
+	public:
+		void begin(unsigned long baud) { (void)baud; }
+		void end() {}
+		void flush() {}
+		size_t write(uint8_t c);
+		size_t print(const char *s);
+		operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+#endif // _SIM_ARDUINO_H
@@ -0,0 +1,193 @@
+/**
+ * @file 		  SimCore.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Core of the host-native simulation: virtual time, I/O registers,
+ * interrupts and sleep.
+ *
+ * Virtual time is counted in cycles of the 32768 Hz watch crystal, so Timer2
+ * periods are exact. Time only advances while the simulated CPU sleeps
+ * (or waits in a library delay), code that runs while awake takes zero time.
+ */
+
+#ifndef _SIMCORE_H
+#define _SIMCORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//===========================================================================
+#pragma region I/O registers
+
+/// An 8-bit I/O register, with optional hooks to model peripheral behaviour
+class SimReg8
+{
+	public:
+		typedef uint8_t (*ReadHook)(const SimReg8 &reg);
+		typedef void (*WriteHook)(SimReg8 &reg, uint8_t old);
+
+		SimReg8() : value(0), onRead(NULL), onWrite(NULL) {}
+
+		operator uint8_t() const { return onRead ? onRead(*this) : value; }
+		SimReg8& operator=(uint8_t v) { uint8_t old=value; value=v; if (onWrite) onWrite(*this,old); return *this; }
+		SimReg8& operator=(const SimReg8 &r) { return *this = (uint8_t)r; }
+		SimReg8& operator|=(unsigned v) { return *this = (uint8_t)(*this | v); }
+		SimReg8& operator&=(unsigned v) { return *this = (uint8_t)(*this & v); }
+		SimReg8& operator^=(unsigned v) { return *this = (uint8_t)(*this ^ v); }
+
+		uint8_t value;		///< raw register content
+		ReadHook onRead;	///< if set, called to get value seen by firmware
+		WriteHook onWrite;	///< if set, called after firmware wrote value
+};
+
+/// A 16-bit I/O register (ADC, TCNT1 etc.)
+class SimReg16
+{
+	public:
+		typedef uint16_t (*ReadHook)(const SimReg16 &reg);
+		typedef void (*WriteHook)(SimReg16 &reg, uint16_t old);
+
+		SimReg16() : value(0), onRead(NULL), onWrite(NULL) {}
+
+		operator uint16_t() const { return onRead ? onRead(*this) : value; }
+		SimReg16& operator=(uint16_t v) { uint16_t old=value; value=v; if (onWrite) onWrite(*this,old); return *this; }
+		SimReg16& operator=(const SimReg16 &r) { return *this = (uint16_t)r; }
+		SimReg16& operator|=(unsigned v) { return *this = (uint16_t)(*this | v); }
+		SimReg16& operator&=(unsigned v) { return *this = (uint16_t)(*this & v); }
+
+		uint16_t value;
+		ReadHook onRead;
+		WriteHook onWrite;
+};
+
+#pragma endregion
+//===========================================================================
+#pragma region Virtual time
+
+typedef uint64_t simtime_t;		///< virtual time in 32768 Hz crystal cycles
+
+#define SIM_TICKS_PER_SECOND	32768uL
+#define SIM_FOREVER				UINT64_MAX
+
+simtime_t simNow();
+inline simtime_t simMsToTicks(uint64_t ms) { return (ms * SIM_TICKS_PER_SECOND + 500u) / 1000u; }
+inline uint64_t simTicksToMs(simtime_t t) { return (t * 1000u) / SIM_TICKS_PER_SECOND; }
+const char* simTimeString(simtime_t t);
+
+/// advance time while awake (e.g. in a library delay), servicing interrupts
+void simAdvanceTo(simtime_t t);
+/// execute SLEEP instruction: advance to next interrupt and service it
+void simSleep();
+
+#pragma endregion
+//===========================================================================
+#pragma region Interrupts
+
+void simCli();
+void simSei();
+
+/// a peripheral that can raise interrupts at some point in virtual time
+struct SimEventSource
+{
+	/// time of next event, or SIM_FOREVER
+	simtime_t (*next)();
+	/// handle event due at time t (t==simNow())
+	void (*fire)(simtime_t t);
+};
+
+void simAddEventSource(const SimEventSource *src);
+
+/// call an interrupt vector the way the hardware does, with I flag cleared
+void simCallVector(void (*vector)(void));
+
+#pragma endregion
+//===========================================================================
+#pragma region Pins, traces and EEPROM
+
+/**
+ * @brief A reed switch, connected between an input pin with pull-up
+ * and an output pin that is driven LOW while the contact is polled
+ */
+struct SimSwitch
+{
+	char port;			///< 'B','C' or 'D'
+	uint8_t bit;		///< input pin
+	char retPort;		///< return pin port, or 0 if contact goes to GND
+	uint8_t retBit;		///< return pin
+};
+
+/// trace and wiring of the gas meter reed switch
+bool simLoadTrace(const char *path, bool repeat);
+void simAttachSwitch(const SimSwitch &sw);
+bool simSwitchClosed(simtime_t t);
+/// another contact with its own trace, e.g. a water meter
+bool simAddContact(const SimSwitch &sw, const char *path, bool repeat);
+
+/// light level at the phototransistor, as fraction of full scale 0..1
+extern double simLightLevel;
+/// supply voltage in mV
+extern uint16_t simVccMillivolts;
+/// temperature in °C and relative humidity in % at the BME280
+extern double simTemperature;
+extern double simHumidity;
+
+/// EEPROM content, erased (0xFF) unless loaded from file
+extern uint8_t simEeprom[];
+bool simLoadEeprom(const char *path);
+bool simSaveEeprom(const char *path);
+
+#pragma endregion
+//===========================================================================
+#pragma region I2C bus
+
+/// an I2C slave on the bus driven by the simulated TWI
+struct SimI2cDevice
+{
+	uint8_t addr;					///< 7-bit address
+	void (*start)(bool read);		///< addressed after (repeated) START
+	bool (*write)(uint8_t data);	///< byte from master, return true for ACK
+	uint8_t (*read)();				///< byte to master
+};
+
+void simAddI2cDevice(const SimI2cDevice *dev);
+
+#pragma endregion
+//===========================================================================
+#pragma region Statistics
+
+struct SimStats
+{
+	uint64_t wakeups;		///< number of times the CPU woke from sleep
+	simtime_t idleTime;		///< time asleep in SLEEP_MODE_IDLE, with the I/O clock running
+	uint64_t interrupts;	///< number of interrupt service routines run
+	uint64_t loops;			///< number of calls to loop()
+	uint64_t txMessages;	///< RF messages sent
+	uint64_t txFailed;		///< RF messages not acknowledged by gateway
+	uint64_t rxMessages;	///< RF messages received
+	uint64_t rxLost;		///< messages from controller lost while radio off
+	uint64_t eepromWrites;	///< EEPROM bytes written
+};
+
+extern SimStats simStats;
+extern bool simDebug;
+
+#pragma endregion
+
+#endif // _SIMCORE_H
@@ -0,0 +1,21 @@
+/*
+ * Stand-in for <avr/boot.h> in the host-native simulation build.
+ * Fuse values are those of boards/mysensors328_rc8.json
+ */
+
+#ifndef _SIM_AVR_BOOT_H
+#define _SIM_AVR_BOOT_H
+
+#include <avr/io.h>
+
+#define GET_LOW_FUSE_BITS		(0x0000)
+#define GET_LOCK_BITS			(0x0001)
+#define GET_EXTENDED_FUSE_BITS	(0x0002)
+#define GET_HIGH_FUSE_BITS		(0x0003)
+
+#define boot_lock_fuse_bits_get(addr) \
+	((addr)==GET_LOW_FUSE_BITS ? 0xE2 : \
+	 (addr)==GET_HIGH_FUSE_BITS ? 0xDE : \
+	 (addr)==GET_EXTENDED_FUSE_BITS ? 0x06 : 0xFF)
+
+#endif // _SIM_AVR_BOOT_H
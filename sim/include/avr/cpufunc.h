@@ -0,0 +1,11 @@
+/*
+ * Stand-in for <avr/cpufunc.h> in the host-native simulation build.
+ */
+
+#ifndef _SIM_AVR_CPUFUNC_H
+#define _SIM_AVR_CPUFUNC_H
+
+#define _NOP()			do { } while (0)
+#define _MemoryBarrier()	__asm__ __volatile__("" ::: "memory")
+
+#endif // _SIM_AVR_CPUFUNC_H
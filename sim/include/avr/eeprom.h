@@ -0,0 +1,25 @@
+/*
+ * Stand-in for <avr/eeprom.h> in the host-native simulation build.
+ * The EEPROM content lives in simEeprom[], see SimEeprom.cpp.
+ */
+
+#ifndef _SIM_AVR_EEPROM_H
+#define _SIM_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+
+#define EEMEM
+
+uint8_t eeprom_read_byte( const uint8_t *addr );
+void eeprom_write_byte( uint8_t *addr, uint8_t value );
+void eeprom_update_byte( uint8_t *addr, uint8_t value );
+void eeprom_read_block( void *dst, const void *src, size_t n );
+void eeprom_write_block( const void *src, void *dst, size_t n );
+void eeprom_update_block( const void *src, void *dst, size_t n );
+
+#define eeprom_is_ready()	1
+#define eeprom_busy_wait()	do {} while (0)
+
+#endif // _SIM_AVR_EEPROM_H
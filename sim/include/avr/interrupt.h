@@ -0,0 +1,25 @@
+/*
+ * Stand-in for <avr/interrupt.h> in the host-native simulation build.
+ */
+
+#ifndef _SIM_AVR_INTERRUPT_H
+#define _SIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define sei()	simSei()
+#define cli()	simCli()
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define reti()	return
+
+#define ISR(vector, ...) \
+	extern "C" void vector(void); \
+	extern "C" void vector(void)
+
+#define EMPTY_INTERRUPT(vector) \
+	extern "C" void vector(void) {}
+
+#endif // _SIM_AVR_INTERRUPT_H
@@ -0,0 +1,232 @@
+/*
+ * Stand-in for <avr/io.h> in the host-native simulation build.
+ * Registers and bit numbers are those of the ATmega328P.
+ */
+
+#ifndef _SIM_AVR_IO_H
+#define _SIM_AVR_IO_H
+
+#include <stdint.h>
+#include "SimCore.h"
+
+#ifndef __AVR_ATmega328P__
+ #define __AVR_ATmega328P__
+#endif
+
+#define _BV(bit) (1 << (bit))
+#define bit_is_set(sfr,bit)   ((sfr) & _BV(bit))
+#define bit_is_clear(sfr,bit) (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr,bit)   do { } while (bit_is_clear(sfr,bit))
+#define loop_until_bit_is_clear(sfr,bit) do { } while (bit_is_set(sfr,bit))
+
+//----- ports
+
+extern SimReg8 PINB, DDRB, PORTB;
+extern SimReg8 PINC, DDRC, PORTC;
+extern SimReg8 PIND, DDRD, PORTD;
+
+//----- status, sleep and power
+
+extern SimReg8 SREG, SMCR, MCUCR, MCUSR, PRR, CLKPR, OSCCAL, GTCCR;
+
+#define SE		0
+#define SM0		1
+#define SM1		2
+#define SM2		3
+
+#define IVCE	0
+#define IVSEL	1
+#define PUD		4
+#define BODSE	5
+#define BODS	6
+
+#define PRADC	 0
+#define PRUSART0 1
+#define PRSPI	 2
+#define PRTIM1	 3
+#define PRTIM0	 5
+#define PRTIM2	 6
+#define PRTWI	 7
+
+#define CLKPS0	0
+#define CLKPS1	1
+#define CLKPS2	2
+#define CLKPS3	3
+#define CLKPCE	7
+
+#define TSM		7
+#define PSRASY	1
+#define PSRSYNC	0
+
+//----- external interrupts
+
+extern SimReg8 EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+
+#define ISC00	0
+#define ISC01	1
+#define ISC10	2
+#define ISC11	3
+#define INT0	0
+#define INT1	1
+#define INTF0	0
+#define INTF1	1
+#define PCIE0	0
+#define PCIE1	1
+#define PCIE2	2
+#define PCIF0	0
+#define PCIF1	1
+#define PCIF2	2
+#define PCINT21	5
+
+//----- Timer0
+
+extern SimReg8 TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+
+#define TOIE0	0
+#define OCIE0A	1
+#define OCIE0B	2
+
+//----- Timer1
+
+extern SimReg8 TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern SimReg16 TCNT1, OCR1A, OCR1B, ICR1;
+
+#define WGM10	0
+#define WGM11	1
+#define COM1B0	4
+#define COM1B1	5
+#define COM1A0	6
+#define COM1A1	7
+#define CS10	0
+#define CS11	1
+#define CS12	2
+#define WGM12	3
+#define WGM13	4
+#define ICES1	6
+#define ICNC1	7
+#define TOIE1	0
+#define OCIE1A	1
+#define OCIE1B	2
+#define ICIE1	5
+#define TOV1	0
+#define OCF1A	1
+#define OCF1B	2
+#define ICF1	5
+
+//----- Timer2
+
+extern SimReg8 TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2, ASSR;
+
+#define WGM20	0
+#define WGM21	1
+#define COM2B0	4
+#define COM2B1	5
+#define COM2A0	6
+#define COM2A1	7
+#define CS20	0
+#define CS21	1
+#define CS22	2
+#define WGM22	3
+#define FOC2B	6
+#define FOC2A	7
+#define TOIE2	0
+#define OCIE2A	1
+#define OCIE2B	2
+#define TOV2	0
+#define OCF2A	1
+#define OCF2B	2
+#define TCR2BUB	0
+#define TCR2AUB	1
+#define OCR2BUB	2
+#define OCR2AUB	3
+#define TCN2UB	4
+#define AS2		5
+#define EXCLK	6
+
+//----- ADC and analog comparator
+
+extern SimReg8 ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR1, ACSR;
+extern SimReg16 ADC;
+
+#define ADPS0	0
+#define ADPS1	1
+#define ADPS2	2
+#define ADIE	3
+#define ADIF	4
+#define ADATE	5
+#define ADSC	6
+#define ADEN	7
+#define ACME	6
+#define MUX0	0
+#define MUX1	1
+#define MUX2	2
+#define MUX3	3
+#define ADLAR	5
+#define REFS0	6
+#define REFS1	7
+#define ACIS0	0
+#define ACIS1	1
+#define ACIC	2
+#define ACIE	3
+#define ACI		4
+#define ACO		5
+#define ACBG	6
+#define ACD		7
+#define ADC0D	0
+#define ADC1D	1
+#define ADC2D	2
+#define ADC3D	3
+#define ADC4D	4
+#define ADC5D	5
+
+//----- TWI
+
+extern SimReg8 TWBR, TWSR, TWAR, TWDR, TWCR, TWAMR;
+
+#define TWIE	0
+#define TWEN	2
+#define TWWC	3
+#define TWSTO	4
+#define TWSTA	5
+#define TWEA	6
+#define TWINT	7
+#define TWPS0	0
+#define TWPS1	1
+
+//----- EEPROM and watchdog
+
+extern SimReg8 EECR, EEDR, WDTCSR;
+extern SimReg16 EEAR;
+
+#define EERE	0
+#define EEPE	1
+#define EEMPE	2
+#define EERIE	3
+#define EEPM0	4
+#define EEPM1	5
+#define WDP0	0
+#define WDP1	1
+#define WDP2	2
+#define WDE		3
+#define WDCE	4
+#define WDP3	5
+#define WDIE	6
+#define WDIF	7
+
+#define E2END	0x3FF
+
+//----- interrupt vectors the simulation can raise
+
+#define INT0_vect			simVector_INT0
+#define INT1_vect			simVector_INT1
+#define WDT_vect			simVector_WDT
+#define TIMER2_COMPA_vect	simVector_TIMER2_COMPA
+#define TIMER2_OVF_vect		simVector_TIMER2_OVF
+#define TIMER1_COMPA_vect	simVector_TIMER1_COMPA
+#define TIMER1_OVF_vect		simVector_TIMER1_OVF
+#define PCINT2_vect			simVector_PCINT2
+#define ADC_vect			simVector_ADC
+#define TWI_vect			simVector_TWI
+#define EE_READY_vect		simVector_EE_READY
+
+#endif // _SIM_AVR_IO_H
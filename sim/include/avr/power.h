@@ -0,0 +1,35 @@
+/*
+ * Stand-in for <avr/power.h> in the host-native simulation build.
+ */
+
+#ifndef _SIM_AVR_POWER_H
+#define _SIM_AVR_POWER_H
+
+#include <avr/io.h>
+
+typedef enum {
+	clock_div_1 = 0,
+	clock_div_2 = 1,
+	clock_div_4 = 2,
+	clock_div_8 = 3,
+	clock_div_16 = 4,
+	clock_div_32 = 5,
+	clock_div_64 = 6,
+	clock_div_128 = 7,
+	clock_div_256 = 8
+} clock_div_t;
+
+#define clock_prescale_set(div) \
+	do { CLKPR = _BV(CLKPCE); CLKPR = (uint8_t)(div); } while (0)
+#define clock_prescale_get()	((clock_div_t)(CLKPR & 0x0F))
+
+#define power_adc_enable()		(PRR &= (uint8_t)~_BV(PRADC))
+#define power_adc_disable()		(PRR |= (uint8_t)_BV(PRADC))
+#define power_twi_enable()		(PRR &= (uint8_t)~_BV(PRTWI))
+#define power_twi_disable()		(PRR |= (uint8_t)_BV(PRTWI))
+#define power_timer1_enable()	(PRR &= (uint8_t)~_BV(PRTIM1))
+#define power_timer1_disable()	(PRR |= (uint8_t)_BV(PRTIM1))
+#define power_timer2_enable()	(PRR &= (uint8_t)~_BV(PRTIM2))
+#define power_timer2_disable()	(PRR |= (uint8_t)_BV(PRTIM2))
+
+#endif // _SIM_AVR_POWER_H
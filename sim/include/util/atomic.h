@@ -0,0 +1,20 @@
+/*
+ * Stand-in for <util/atomic.h> in the host-native simulation build.
+ */
+
+#ifndef _SIM_UTIL_ATOMIC_H
+#define _SIM_UTIL_ATOMIC_H
+
+#include <avr/io.h>
+
+static inline uint8_t simAtomicEnter() { uint8_t s = SREG; simCli(); return s; }
+static inline void simAtomicRestore(const uint8_t *s) { if (*s & 0x80) simSei(); else simCli(); }
+static inline void simAtomicForceOn(const uint8_t *) { simSei(); }
+
+#define ATOMIC_RESTORESTATE	uint8_t sim_sreg_save __attribute__((__cleanup__(simAtomicRestore))) = simAtomicEnter()
+#define ATOMIC_FORCEON		uint8_t sim_sreg_save __attribute__((__cleanup__(simAtomicForceOn))) = simAtomicEnter()
+
+#define ATOMIC_BLOCK(type) \
+	for ( type, sim_atomic_once = 1; sim_atomic_once; sim_atomic_once = 0 )
+
+#endif // _SIM_UTIL_ATOMIC_H
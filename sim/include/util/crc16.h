@@ -0,0 +1,35 @@
+/*
+ * Stand-in for <util/crc16.h> in the host-native simulation build,
+ * same algorithms as the avr-libc inline assembler versions.
+ */
+
+#ifndef _SIM_UTIL_CRC16_H
+#define _SIM_UTIL_CRC16_H
+
+#include <stdint.h>
+
+static inline uint8_t _crc8_ccitt_update( uint8_t crc, uint8_t data )
+{
+	crc ^= data;
+	for (uint8_t i=0; i<8; i++) 
+		crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	return crc;
+}
+
+static inline uint8_t _crc_ibutton_update( uint8_t crc, uint8_t data )
+{
+	crc ^= data;
+	for (uint8_t i=0; i<8; i++) 
+		crc = (crc & 0x01) ? (uint8_t)((crc >> 1) ^ 0x8C) : (uint8_t)(crc >> 1);
+	return crc;
+}
+
+static inline uint16_t _crc16_update( uint16_t crc, uint8_t data )
+{
+	crc ^= data;
+	for (uint8_t i=0; i<8; i++)
+		crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+	return crc;
+}
+
+#endif // _SIM_UTIL_CRC16_H
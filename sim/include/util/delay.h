@@ -0,0 +1,12 @@
+/*
+ * Stand-in for <util/delay.h> in the host-native simulation build.
+ * Busy waits take no virtual time, like all other code running while awake.
+ */
+
+#ifndef _SIM_UTIL_DELAY_H
+#define _SIM_UTIL_DELAY_H
+
+#define _delay_us(us)	do { (void)(us); } while (0)
+#define _delay_ms(ms)	do { (void)(ms); } while (0)
+
+#endif // _SIM_UTIL_DELAY_H
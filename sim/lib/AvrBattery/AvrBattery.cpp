@@ -0,0 +1,30 @@
+/*
+ * Stand-in for the AvrBattery library in the host-native simulation build.
+ * Measures VCC against the 1.1V bandgap reference with the simulated ADC.
+ */
+
+#include <avr/io.h>
+#include "AvrBattery.h"
+
+#define VCC_EMPTY	1900	// mV
+#define VCC_FULL	3200	// mV
+
+uint16_t AvrBattery::measureVCC()
+{
+	PRR &= (uint8_t)~_BV(PRADC);
+	ADCSRA |= _BV(ADEN);
+	ADMUX = (1 << REFS0) | (14 << MUX0);	// AVCC reference, bandgap input
+	ADCSRA |= _BV(ADSC);
+	while (ADCSRA & _BV(ADSC)) {}
+	uint16_t adc = ADC;
+	ADCSRA = 0;
+	PRR |= _BV(PRADC);
+	return adc ? (uint16_t)(1100uL * 1024uL / adc) : 0;
+}
+
+uint8_t AvrBattery::calcVCC_Percent( uint16_t mv )
+{
+	if (mv <= VCC_EMPTY) return 0;
+	if (mv >= VCC_FULL) return 100;
+	return (uint8_t)((mv - VCC_EMPTY) * 100uL / (VCC_FULL - VCC_EMPTY));
+}
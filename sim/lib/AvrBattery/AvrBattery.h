@@ -0,0 +1,17 @@
+/*
+ * Stand-in for the AvrBattery library in the host-native simulation build.
+ */
+
+#ifndef _SIM_AVRBATTERY_H
+#define _SIM_AVRBATTERY_H
+
+#include <stdint.h>
+
+class AvrBattery
+{
+	public:
+		static uint16_t measureVCC();
+		static uint8_t calcVCC_Percent( uint16_t mv );
+};
+
+#endif // _SIM_AVRBATTERY_H
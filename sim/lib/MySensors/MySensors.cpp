@@ -0,0 +1,391 @@
+/*
+ * Stand-in for the MySensors library in the host-native simulation build:
+ * message logging, radio power state, and a simple controller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "MySensors.h"
+
+int64_t simControllerBaseCount = 0;
+uint32_t simControllerReplyDelay = 200;
+const char *simControllerConfig = NULL;
+bool simLogMessages = true;
+
+uint8_t simMinPaLevel = RF24_PA_MIN;
+
+static bool radioOn = true;
+static uint8_t paLevel = RF24_PA_HIGH;		// MY_RF24_PA_LEVEL in mysensors_conf.h
+static bool uplinkLost = false;				// transport looks for its parent
+
+struct Outage { simtime_t from, to; };
+static std::vector<Outage> outages;			// gateway unreachable
+
+void simAddOutage( simtime_t from, simtime_t to )
+{
+	outages.push_back({ from, to });
+}
+
+static std::vector<uint8_t> lostSensors;	// messages of these children fail
+
+void simLoseSensor( uint8_t sensor )
+{
+	lostSensors.push_back(sensor);
+}
+
+static bool linkDown()
+{
+	simtime_t t = simNow();
+	for (const Outage &o : outages)
+		if (t >= o.from && t < o.to) return true;
+	return false;
+}
+
+bool simRadioOn() { return radioOn; }
+
+//===========================================================================
+#pragma region MyMessage
+
+MyMessage::MyMessage()
+	: sensor(0), type(0), command(C_SET), ack(false),
+	  payloadType(P_STRING), decimals(0), length(0)
+{
+	memset(data, 0, sizeof(data));
+}
+
+
+MyMessage::MyMessage( uint8_t s, mysensors_data_t t )
+	: MyMessage()
+{
+	sensor = s;
+	type = t;
+}
+
+
+MyMessage& MyMessage::set( const void *payload, size_t len )
+{
+	if (len > MAX_PAYLOAD_SIZE) len = MAX_PAYLOAD_SIZE;
+	memcpy(data, payload, len);
+	length = (uint8_t)len;
+	payloadType = P_CUSTOM;
+	return *this;
+}
+
+MyMessage& MyMessage::set( const char *value )
+{
+	size_t len = value ? strlen(value) : 0;
+	if (len > MAX_PAYLOAD_SIZE) len = MAX_PAYLOAD_SIZE;
+	memcpy(data, value, len);
+	data[len] = 0;
+	length = (uint8_t)len;
+	payloadType = P_STRING;
+	return *this;
+}
+
+MyMessage& MyMessage::set( float value, uint8_t dec )
+{
+	memcpy(data, &value, sizeof(value));
+	length = sizeof(value);
+	decimals = dec;
+	payloadType = P_FLOAT32;
+	return *this;
+}
+
+#define SET_INT(argtype,ptype) \
+	MyMessage& MyMessage::set( argtype value ) \
+	{ \
+		memcpy(data, &value, sizeof(value)); \
+		length = sizeof(value); \
+		payloadType = ptype; \
+		return *this; \
+	}
+
+SET_INT(bool, P_BYTE)
+SET_INT(uint8_t, P_BYTE)
+SET_INT(int16_t, P_INT16)
+SET_INT(uint16_t, P_UINT16)
+SET_INT(int32_t, P_LONG32)
+SET_INT(uint32_t, P_ULONG32)
+
+
+const char* MyMessage::getString( char *buffer ) const
+{
+	switch (payloadType) {
+		case P_STRING:
+			memcpy(buffer, data, length);
+			buffer[length] = 0;
+			break;
+		case P_BYTE:	sprintf(buffer, "%u", data[0]); break;
+		case P_INT16:	{ int16_t v; memcpy(&v,data,2); sprintf(buffer, "%d", v); } break;
+		case P_UINT16:	{ uint16_t v; memcpy(&v,data,2); sprintf(buffer, "%u", v); } break;
+		case P_LONG32:	{ int32_t v; memcpy(&v,data,4); sprintf(buffer, "%ld", (long)v); } break;
+		case P_ULONG32:	{ uint32_t v; memcpy(&v,data,4); sprintf(buffer, "%lu", (unsigned long)v); } break;
+		case P_FLOAT32:	{ float v; memcpy(&v,data,4); sprintf(buffer, "%.*f", decimals, v); } break;
+		case P_CUSTOM:
+			for (uint8_t i=0; i<length; i++) sprintf(buffer+2*i, "%02X", data[i]);
+			buffer[2*length] = 0;
+			break;
+	}
+	return buffer;
+}
+
+
+int32_t MyMessage::getLong() const
+{
+	char buf[2*MAX_PAYLOAD_SIZE+1];
+	switch (payloadType) {
+		case P_BYTE:	return data[0];
+		case P_INT16:	{ int16_t v; memcpy(&v,data,2); return v; }
+		case P_UINT16:	{ uint16_t v; memcpy(&v,data,2); return v; }
+		case P_LONG32:	{ int32_t v; memcpy(&v,data,4); return v; }
+		case P_ULONG32:	{ uint32_t v; memcpy(&v,data,4); return (int32_t)v; }
+		case P_FLOAT32:	return (int32_t)getFloat();
+		default:		return (int32_t)strtol(getString(buf), NULL, 10);
+	}
+}
+
+uint32_t MyMessage::getULong() const
+{
+	char buf[2*MAX_PAYLOAD_SIZE+1];
+	if (payloadType == P_STRING) return (uint32_t)strtoul(getString(buf), NULL, 10);
+	return (uint32_t)getLong();
+}
+
+float MyMessage::getFloat() const
+{
+	char buf[2*MAX_PAYLOAD_SIZE+1];
+	if (payloadType == P_FLOAT32) { float v; memcpy(&v,data,4); return v; }
+	if (payloadType == P_STRING) return strtof(getString(buf), NULL);
+	return (float)getLong();
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region Radio and controller
+
+struct PendingRx { simtime_t due; MyMessage msg; };
+
+static std::vector<PendingRx> inFlight;		// sent by controller, not yet at node
+static std::deque<MyMessage> rxFifo;		// received by radio, not yet processed
+
+
+static void logMessage( const char *dir, const MyMessage &msg )
+{
+	if (!simLogMessages) return;
+	char buf[2*MAX_PAYLOAD_SIZE+1];
+	printf("%s %s %u/%u/%u/%u %s\n", simTimeString(simNow()), dir,
+		msg.sensor, msg.command, msg.ack ? 1 : 0, msg.type, msg.getString(buf));
+}
+
+
+static bool transmit( MyMessage &msg )
+{
+	radioOn = true;
+	simStats.txMessages++;
+	indication(INDICATION_TX);
+	if (std::find(lostSensors.begin(), lostSensors.end(), msg.sensor) != lostSensors.end()) {
+		simStats.txFailed++;
+		logMessage("FAIL", msg);
+		indication(INDICATION_ERR_TX);
+		return false;
+	}
+	if (linkDown() || paLevel < simMinPaLevel) {
+		simStats.txFailed++;
+		logMessage("FAIL", msg);
+		indication(INDICATION_ERR_TX);
+		uplinkLost = true;
+		return false;
+	}
+	logMessage("TX", msg);
+	return true;
+}
+
+
+static simtime_t controllerNext()
+{
+	simtime_t t = SIM_FOREVER;
+	for (const PendingRx &p : inFlight)
+		if (p.due < t) t = p.due;
+	return t;
+}
+
+static void controllerFire( simtime_t t )
+{
+	for (size_t i=0; i<inFlight.size(); ) {
+		if (inFlight[i].due <= t) {
+			if (radioOn) {
+				rxFifo.push_back(inFlight[i].msg);
+			} else {
+				simStats.rxLost++;
+				logMessage("LOST", inFlight[i].msg);
+			}
+			inFlight.erase(inFlight.begin() + i);
+		} else i++;
+	}
+}
+
+static const SimEventSource controllerSource = { controllerNext, controllerFire };
+
+static struct ControllerInit {
+	ControllerInit() { simAddEventSource(&controllerSource); }
+} controllerInit;
+
+
+/// what the controller does with a message from the node
+static void controllerReceive( const MyMessage &msg )
+{
+	if (msg.command == C_REQ && msg.type == V_VAR1 && simControllerBaseCount >= 0) {
+		char buf[24];
+		snprintf(buf, sizeof(buf), "%lld", (long long)simControllerBaseCount);
+		PendingRx reply{ simNow() + simMsToTicks(simControllerReplyDelay), MyMessage() };
+		reply.msg.setSensor(msg.sensor).setType(msg.type).setCommand(C_SET);
+		reply.msg.set(buf);
+		inFlight.push_back(reply);
+	}
+	if (msg.command == C_REQ && msg.type == V_VAR4 && simControllerConfig) {
+		PendingRx reply{ simNow() + simMsToTicks(simControllerReplyDelay), MyMessage() };
+		reply.msg.setSensor(msg.sensor).setType(msg.type).setCommand(C_SET);
+		reply.msg.set(simControllerConfig);
+		inFlight.push_back(reply);
+	}
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region MySensors API
+
+bool send( MyMessage &msg, const bool requestEcho )
+{
+	(void)requestEcho;
+	msg.command = C_SET;
+	bool ok = transmit(msg);
+	if (ok) controllerReceive(msg);
+	return ok;
+}
+
+
+bool request( const uint8_t childSensorId, const uint8_t variableType, const uint8_t destination )
+{
+	(void)destination;
+	MyMessage msg;
+	msg.setSensor(childSensorId).setType(variableType).setCommand(C_REQ);
+	msg.set("");
+	bool ok = transmit(msg);
+	if (ok) controllerReceive(msg);
+	return ok;
+}
+
+
+bool present( const uint8_t sensorId, const mysensors_sensor_t sensorType,
+			  const char *description, const bool requestEcho )
+{
+	(void)requestEcho;
+	MyMessage msg;
+	msg.setSensor(sensorId).setType(sensorType).setCommand(C_PRESENTATION);
+	msg.set(description);
+	return transmit(msg);
+}
+
+
+static bool sendInternal( uint8_t type, const char *value )
+{
+	MyMessage msg;
+	msg.setSensor(NODE_SENSOR_ID).setType(type).setCommand(C_INTERNAL);
+	msg.set(value);
+	return transmit(msg);
+}
+
+
+bool sendSketchInfo( const char *name, const char *version, const bool requestEcho )
+{
+	(void)requestEcho;
+	bool ok = true;
+	if (name) ok &= sendInternal(I_SKETCH_NAME, name);
+	if (version) ok &= sendInternal(I_SKETCH_VERSION, version);
+	return ok;
+}
+
+
+bool sendBatteryLevel( const uint8_t level, const bool requestEcho )
+{
+	(void)requestEcho;
+	char buf[4];
+	snprintf(buf, sizeof(buf), "%u", level);
+	return sendInternal(I_BATTERY_LEVEL, buf);
+}
+
+
+bool sendHeartbeat( const bool requestEcho )
+{
+	(void)requestEcho;
+	return sendInternal(I_HEARTBEAT_RESPONSE, "");
+}
+
+
+bool RF24_setTxPowerLevel( const uint8_t powerLevel )
+{
+	paLevel = powerLevel & 3;
+	return true;
+}
+
+
+/// after a failed transmission, the transport is not ready until the gateway can be reached again
+bool isTransportReady()
+{
+	return !uplinkLost;
+}
+
+
+void transportDisable()
+{
+	radioOn = false;
+}
+
+
+void transportReInitialise()
+{
+	radioOn = true;
+}
+
+
+void _process()
+{
+	if (uplinkLost && !linkDown()) uplinkLost = false;
+	while (!rxFifo.empty()) {
+		MyMessage msg = rxFifo.front();
+		rxFifo.pop_front();
+		simStats.rxMessages++;
+		logMessage("RX", msg);
+		receive(msg);
+	}
+}
+
+
+void sleep( const uint32_t ms, const bool smartSleep )
+{
+	(void)smartSleep;
+	transportDisable();
+	simAdvanceTo(simNow() + simMsToTicks(ms));
+	simStats.wakeups++;
+	transportReInitialise();
+}
+
+
+void wait( const uint32_t ms )
+{
+	simAdvanceTo(simNow() + simMsToTicks(ms));
+	_process();
+}
+
+
+uint8_t getNodeId()
+{
+	return MY_NODE_ID;
+}
+
+#pragma endregion
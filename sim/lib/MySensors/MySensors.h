@@ -0,0 +1,166 @@
+/*
+ * Stand-in for the MySensors library in the host-native simulation build.
+ *
+ * Messages sent by the node are logged to stdout, one per line, as
+ *   <virtual time> TX <sensor>/<command>/<ack>/<type> <payload>
+ * i.e. the same topic layout as published by the MQTT gateway.
+ * A simulated controller answers V_VAR1 requests with a base count.
+ */
+
+#ifndef _SIM_MYSENSORS_H
+#define _SIM_MYSENSORS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SimCore.h"
+
+#ifndef MY_NODE_ID
+ #error "must define MY_NODE_ID"
+#endif
+
+#define MAX_PAYLOAD_SIZE	25
+#define EEPROM_LOCAL_CONFIG_ADDRESS	413		// first EEPROM byte not used by MySensors 2.3
+#define NODE_SENSOR_ID		255
+
+typedef enum {
+	C_PRESENTATION = 0, C_SET = 1, C_REQ = 2, C_INTERNAL = 3, C_STREAM = 4
+} mysensors_command_t;
+
+typedef enum {
+	S_DOOR = 0, S_MOTION, S_SMOKE, S_BINARY, S_DIMMER, S_COVER, S_TEMP, S_HUM,
+	S_BARO, S_WIND, S_RAIN, S_UV, S_WEIGHT, S_POWER, S_HEATER, S_DISTANCE,
+	S_LIGHT_LEVEL, S_ARDUINO_NODE, S_ARDUINO_REPEATER_NODE, S_LOCK, S_IR,
+	S_WATER, S_AIR_QUALITY, S_CUSTOM, S_DUST, S_SCENE_CONTROLLER, S_RGB_LIGHT,
+	S_RGBW_LIGHT, S_COLOR_SENSOR, S_HVAC, S_MULTIMETER, S_SPRINKLER,
+	S_WATER_LEAK, S_SOUND, S_VIBRATION, S_MOISTURE, S_INFO, S_GAS, S_GPS,
+	S_WATER_QUALITY
+} mysensors_sensor_t;
+
+typedef enum {
+	V_TEMP = 0, V_HUM, V_STATUS, V_PERCENTAGE, V_PRESSURE, V_FORECAST, V_RAIN,
+	V_RAINRATE, V_WIND, V_GUST, V_DIRECTION, V_UV, V_WEIGHT, V_DISTANCE,
+	V_IMPEDANCE, V_ARMED, V_TRIPPED, V_WATT, V_KWH, V_SCENE_ON, V_SCENE_OFF,
+	V_HVAC_FLOW_STATE, V_HVAC_SPEED, V_LIGHT_LEVEL, V_VAR1, V_VAR2, V_VAR3,
+	V_VAR4, V_VAR5, V_UP, V_DOWN, V_STOP, V_IR_SEND, V_IR_RECEIVE, V_FLOW,
+	V_VOLUME, V_LOCK_STATUS, V_LEVEL, V_VOLTAGE, V_CURRENT, V_RGB, V_RGBW, V_ID,
+	V_UNIT_PREFIX, V_HVAC_SETPOINT_COOL, V_HVAC_SETPOINT_HEAT, V_HVAC_FLOW_MODE,
+	V_TEXT, V_CUSTOM, V_POSITION, V_IR_RECORD, V_PH, V_ORP, V_EC, V_VAR, V_VA,
+	V_POWER_FACTOR
+} mysensors_data_t;
+
+typedef enum {
+	I_BATTERY_LEVEL = 0, I_TIME = 1, I_VERSION = 2, I_ID_REQUEST = 3,
+	I_SKETCH_NAME = 11, I_SKETCH_VERSION = 12, I_HEARTBEAT_RESPONSE = 22
+} mysensors_internal_t;
+
+typedef enum {
+	P_STRING = 0, P_BYTE, P_INT16, P_UINT16, P_LONG32, P_ULONG32, P_CUSTOM, P_FLOAT32
+} mysensors_payload_t;
+
+typedef enum {
+	INDICATION_TX, INDICATION_RX, INDICATION_GW_TX, INDICATION_GW_RX,
+	INDICATION_FIND_PARENT, INDICATION_GOT_PARENT, INDICATION_REQ_NODEID,
+	INDICATION_GOT_NODEID, INDICATION_CHECK_UPLINK, INDICATION_PRESENT,
+	INDICATION_CLEAR_ROUTING, INDICATION_SLEEP, INDICATION_WAKEUP,
+	INDICATION_FW_RX, INDICATION_FW_RX_ERR, INDICATION_ERR_TX = 100
+} indication_t;
+
+
+class MyMessage
+{
+	public:
+		MyMessage();
+		MyMessage( uint8_t sensor, mysensors_data_t dataType );
+
+		MyMessage& set( const void *payload, size_t length );
+		MyMessage& set( const char *value );
+		MyMessage& set( float value, uint8_t decimals );
+		MyMessage& set( bool value );
+		MyMessage& set( uint8_t value );
+		MyMessage& set( int16_t value );
+		MyMessage& set( uint16_t value );
+		MyMessage& set( int32_t value );
+		MyMessage& set( uint32_t value );
+
+		MyMessage& setSensor( uint8_t s ) { sensor = s; return *this; }
+		MyMessage& setType( uint8_t t ) { type = t; return *this; }
+		MyMessage& setCommand( uint8_t c ) { command = c; return *this; }
+
+		uint8_t getSensor() const { return sensor; }
+		uint8_t getType() const { return type; }
+		uint8_t getCommand() const { return command; }
+		uint8_t getLength() const { return length; }
+		mysensors_payload_t getPayloadType() const { return payloadType; }
+		bool isAck() const { return ack; }
+		bool isEcho() const { return ack; }
+
+		const void* getCustom() const { return data; }
+		const char* getString( char *buffer ) const;
+		bool getBool() const { return getLong() != 0; }
+		uint8_t getByte() const { return (uint8_t)getLong(); }
+		int16_t getInt() const { return (int16_t)getLong(); }
+		uint16_t getUInt() const { return (uint16_t)getULong(); }
+		int32_t getLong() const;
+		uint32_t getULong() const;
+		float getFloat() const;
+
+		uint8_t sensor;
+		uint8_t type;
+		uint8_t command;
+		bool ack;
+		mysensors_payload_t payloadType;
+		uint8_t decimals;
+		uint8_t length;
+		uint8_t data[MAX_PAYLOAD_SIZE + 1];
+};
+
+bool send( MyMessage &msg, const bool requestEcho=false );
+bool request( const uint8_t childSensorId, const uint8_t variableType, const uint8_t destination=0 );
+bool present( const uint8_t sensorId, const mysensors_sensor_t sensorType,
+			  const char *description="", const bool requestEcho=false );
+bool sendSketchInfo( const char *name, const char *version, const bool requestEcho=false );
+bool sendBatteryLevel( const uint8_t level, const bool requestEcho=false );
+bool sendHeartbeat( const bool requestEcho=false );
+
+#define RF24_PA_MIN		(0)
+#define RF24_PA_LOW		(1)
+#define RF24_PA_HIGH	(2)
+#define RF24_PA_MAX		(3)
+
+bool RF24_setTxPowerLevel( const uint8_t powerLevel );
+
+bool isTransportReady();
+void transportDisable();
+void transportReInitialise();
+void _process();
+void sleep( const uint32_t ms, const bool smartSleep=false );
+void wait( const uint32_t ms );
+uint8_t getNodeId();
+
+// functions the sketch provides
+void presentation();
+void receive( const MyMessage &message );
+void indication( const indication_t ind );
+
+//----- control of the simulated radio link and controller
+
+/// base count the controller sends in reply to a V_VAR1 request, <0 for no reply
+extern int64_t simControllerBaseCount;
+/// text the controller sends in reply to a V_VAR4 request, NULL for no reply
+extern const char *simControllerConfig;
+/// delay between request and reply, in ms
+extern uint32_t simControllerReplyDelay;
+
+/// messages sent with a lower RF24 PA level than this are lost
+extern uint8_t simMinPaLevel;
+
+/// log messages to stdout?
+extern bool simLogMessages;
+
+bool simRadioOn();
+/// gateway is unreachable from `from` to `to`, send() fails
+void simAddOutage( simtime_t from, simtime_t to );
+/// messages of this child sensor are never acknowledged, the others are
+void simLoseSensor( uint8_t sensor );
+
+#endif // _SIM_MYSENSORS_H
@@ -0,0 +1,18 @@
+/*
+ * Stand-in for the debugstream library in the host-native simulation build.
+ * Debug output goes to stderr if the simulation runs with --debug,
+ * i.e. as if an FTDI adapter was connected.
+ */
+
+#ifndef _SIM_DEBUGSTREAM_H
+#define _SIM_DEBUGSTREAM_H
+
+#include <stdio.h>
+#include "SimCore.h"
+
+#define DEBUG_PRINT(s) \
+	do { if (simDebug) fputs((s), stderr); } while (0)
+#define DEBUG_PRINTF(fmt, ...) \
+	do { if (simDebug) fprintf(stderr, (fmt), ##__VA_ARGS__); } while (0)
+
+#endif // _SIM_DEBUGSTREAM_H
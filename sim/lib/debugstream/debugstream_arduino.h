@@ -0,0 +1,10 @@
+/*
+ * Stand-in for the debugstream Arduino binding in the host-native simulation build.
+ */
+
+#ifndef _SIM_DEBUGSTREAM_ARDUINO_H
+#define _SIM_DEBUGSTREAM_ARDUINO_H
+
+#include "debugstream.h"
+
+#endif // _SIM_DEBUGSTREAM_ARDUINO_H
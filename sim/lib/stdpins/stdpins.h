@@ -0,0 +1,57 @@
+/*
+ * Stand-in for the stdpins library in the host-native simulation build.
+ * A pin is given as a triple  port,bit,polarity  e.g.  D,3,ACTIVE_LOW
+ */
+
+#ifndef _SIM_STDPINS_H
+#define _SIM_STDPINS_H
+
+#include <avr/io.h>
+
+#define _UART_RX	D,0,ACTIVE_HIGH
+#define _UART_TX	D,1,ACTIVE_HIGH
+#define _I2C_SDA	C,4,ACTIVE_HIGH
+#define _I2C_SCL	C,5,ACTIVE_HIGH
+
+#define BV(pin)					_SP_BV(pin)
+#define portBIT(pin)			_SP_BIT(pin)
+#define AS_OUTPUT(pin)			_SP_AS_OUTPUT(pin)
+#define AS_INPUT(pin)			_SP_AS_INPUT(pin)
+#define AS_INPUT_PU(pin)		_SP_AS_INPUT_PU(pin)
+#define AS_INPUT_FLOAT(pin)		_SP_AS_INPUT_FLOAT(pin)
+#define PULLUP_ENABLE(pin)		_SP_SET_HIGH(pin)
+#define PULLUP_DISABLE(pin)		_SP_SET_LOW(pin)
+#define SET_HIGH(pin)			_SP_SET_HIGH(pin)
+#define SET_LOW(pin)			_SP_SET_LOW(pin)
+#define TOGGLE(pin)				_SP_TOGGLE(pin)
+#define IS_HIGH(pin)			_SP_IS_HIGH(pin)
+#define IS_LOW(pin)				(!_SP_IS_HIGH(pin))
+#define ASSERT(pin)				_SP_ASSERT(pin)
+#define NEGATE(pin)				_SP_NEGATE(pin)
+#define IS_TRUE(pin)			_SP_IS_TRUE(pin)
+#define SET_PA(pin,val)			_SP_SET_PA(pin,val)
+
+#define _SP_BV(port,bit,pol)			_BV(bit)
+#define _SP_BIT(port,bit,pol)			(bit)
+#define _SP_AS_OUTPUT(port,bit,pol)		(DDR##port |= _BV(bit))
+#define _SP_AS_INPUT(port,bit,pol)		(DDR##port &= (uint8_t)~_BV(bit))
+#define _SP_AS_INPUT_PU(port,bit,pol)	(DDR##port &= (uint8_t)~_BV(bit), PORT##port |= _BV(bit))
+#define _SP_AS_INPUT_FLOAT(port,bit,pol) (DDR##port &= (uint8_t)~_BV(bit), PORT##port &= (uint8_t)~_BV(bit))
+#define _SP_SET_HIGH(port,bit,pol)		(PORT##port |= _BV(bit))
+#define _SP_SET_LOW(port,bit,pol)		(PORT##port &= (uint8_t)~_BV(bit))
+#define _SP_TOGGLE(port,bit,pol)		(PORT##port ^= _BV(bit))
+#define _SP_IS_HIGH(port,bit,pol)		((PIN##port & _BV(bit)) != 0)
+#define _SP_ASSERT(port,bit,pol)		_SP_ASSERT_##pol(port,bit)
+#define _SP_NEGATE(port,bit,pol)		_SP_NEGATE_##pol(port,bit)
+#define _SP_IS_TRUE(port,bit,pol)		_SP_IS_TRUE_##pol(port,bit)
+#define _SP_SET_PA(port,bit,pol,val) \
+	do { if (val) _SP_ASSERT_##pol(port,bit); else _SP_NEGATE_##pol(port,bit); } while (0)
+
+#define _SP_ASSERT_ACTIVE_HIGH(port,bit)	(PORT##port |= _BV(bit))
+#define _SP_ASSERT_ACTIVE_LOW(port,bit)		(PORT##port &= (uint8_t)~_BV(bit))
+#define _SP_NEGATE_ACTIVE_HIGH(port,bit)	(PORT##port &= (uint8_t)~_BV(bit))
+#define _SP_NEGATE_ACTIVE_LOW(port,bit)		(PORT##port |= _BV(bit))
+#define _SP_IS_TRUE_ACTIVE_HIGH(port,bit)	((PIN##port & _BV(bit)) != 0)
+#define _SP_IS_TRUE_ACTIVE_LOW(port,bit)	((PIN##port & _BV(bit)) == 0)
+
+#endif // _SIM_STDPINS_H
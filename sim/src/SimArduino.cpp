@@ -0,0 +1,62 @@
+/**
+ * @file 		  SimArduino.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief The bits of the Arduino core used by the node, for the simulation build.
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+
+#include "SimCore.h"
+
+HardwareSerial Serial;
+
+
+size_t HardwareSerial::write( uint8_t c )
+{
+	if (simDebug) fputc(c, stderr);
+	return 1;
+}
+
+
+size_t HardwareSerial::print( const char *s )
+{
+	if (simDebug) fputs(s, stderr);
+	return strlen(s);
+}
+
+
+unsigned long millis()
+{
+	return (unsigned long)simTicksToMs(simNow());
+}
+
+
+unsigned long micros()
+{
+	return (unsigned long)(simNow() * 1000000uLL / SIM_TICKS_PER_SECOND);
+}
+
+
+void delay( unsigned long ms )
+{
+	simAdvanceTo(simNow() + simMsToTicks(ms));
+}
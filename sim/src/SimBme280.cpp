@@ -0,0 +1,177 @@
+/**
+ * @file 		  SimBme280.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief A BME280 at address 0x76, on the I2C bus of the simulated TWI.
+ *
+ * The BME280 model has a register file with the calibration example from 
+ * the datasheet. A forced measurement completes immediately, the raw ADC 
+ * values are found by inverting the datasheet's floating point compensation 
+ * formulas for the temperature and humidity given with --temp and --hum, 
+ * so the integer compensation in the node can be checked against them.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "SimCore.h"
+
+double simTemperature = 20.0;
+double simHumidity = 50.0;
+
+//===========================================================================
+#pragma region BME280 model
+
+#define BME_ADDR		0x76
+
+static uint8_t bmeRegs[256];
+static uint8_t bmePointer;
+
+// calibration values, T and P from datasheet example, H from a real sensor
+static const uint16_t T1 = 27504;
+static const int16_t T2 = 26435, T3 = -1000;
+static const uint8_t H1 = 75, H3 = 0;
+static const int16_t H2 = 362, H4 = 313, H5 = 50;
+static const int8_t H6 = 30;
+
+
+static void put16( uint8_t reg, uint16_t v )
+{
+	bmeRegs[reg] = v & 0xFF;
+	bmeRegs[reg+1] = v >> 8;
+}
+
+
+static void bmeReset()
+{
+	static const int16_t P[9] = { (int16_t)36477u, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+	memset(bmeRegs, 0, sizeof(bmeRegs));
+	bmeRegs[0xD0] = 0x60;
+	put16(0x88, T1);
+	put16(0x8A, (uint16_t)T2);
+	put16(0x8C, (uint16_t)T3);
+	for (int i=0; i<9; i++) put16(0x8E + 2*i, (uint16_t)P[i]);
+	bmeRegs[0xA1] = H1;
+	put16(0xE1, (uint16_t)H2);
+	bmeRegs[0xE3] = H3;
+	bmeRegs[0xE4] = (uint8_t)(H4 >> 4);
+	bmeRegs[0xE5] = (uint8_t)(((H5 & 0x0F) << 4) | (H4 & 0x0F));
+	bmeRegs[0xE6] = (uint8_t)(H5 >> 4);
+	bmeRegs[0xE7] = (uint8_t)H6;
+	bmeRegs[0xFA] = 0x80;				// "no measurement" values after reset
+	bmeRegs[0xFD] = 0x80;
+}
+
+
+/// datasheet 8.1, bme280_compensate_T_double()
+static double tFine( uint32_t adc )
+{
+	double var1 = (adc/16384.0 - T1/1024.0) * T2;
+	double var2 = (adc/131072.0 - T1/8192.0) * (adc/131072.0 - T1/8192.0) * T3;
+	return var1 + var2;
+}
+
+
+/// datasheet 8.1, bme280_compensate_H_double()
+static double humidity( uint32_t adc, double t_fine )
+{
+	double h = t_fine - 76800.0;
+	h = (adc - (H4 * 64.0 + H5 / 16384.0 * h)) * 
+		(H2 / 65536.0 * (1.0 + H6 / 67108864.0 * h * (1.0 + H3 / 67108864.0 * h)));
+	h = h * (1.0 - H1 * h / 524288.0);
+	return h;
+}
+
+
+/// smallest ADC value in [0,top) for which f(adc) >= target, f monotonic
+template<class F>
+static uint32_t invert( F f, uint32_t top, double target )
+{
+	uint32_t lo = 0, hi = top;
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+		if (f(mid) < target) lo = mid + 1; else hi = mid;
+	}
+	return lo;
+}
+
+
+static void bmeMeasure()
+{
+	uint8_t meas = bmeRegs[0xF4];
+	uint32_t adcT = 0x80000, adcH = 0x8000;
+
+	if (meas >> 5) {
+		adcT = invert([](uint32_t a) { return tFine(a) / 5120.0; }, 0xFFFFF, simTemperature);
+		if (bmeRegs[0xF2] & 7) {
+			double t_fine = tFine(adcT);
+			adcH = invert([t_fine](uint32_t a) { return humidity(a, t_fine); }, 0xFFFF, simHumidity);
+		}
+	}
+	bmeRegs[0xFA] = adcT >> 12;
+	bmeRegs[0xFB] = (adcT >> 4) & 0xFF;
+	bmeRegs[0xFC] = (adcT << 4) & 0xF0;
+	bmeRegs[0xFD] = adcH >> 8;
+	bmeRegs[0xFE] = adcH & 0xFF;
+	bmeRegs[0xF4] = meas & ~3;			// back to sleep mode
+}
+
+
+static bool bmeFirst;			// next byte written is the register address
+
+static void bmeStart( bool read )
+{
+	bmeFirst = !read;
+}
+
+
+/// register address, then data for consecutive registers
+static bool bmeWrite( uint8_t data )
+{
+	if (bmeFirst) {
+		bmePointer = data;
+		bmeFirst = false;
+		return true;
+	}
+	uint8_t reg = bmePointer++;
+	if (reg == 0xE0 && data == 0xB6) {
+		bmeReset();
+	} else if (reg == 0xF2 || reg == 0xF4 || reg == 0xF5) {	// others are read-only
+		bmeRegs[reg] = data;
+		if (reg == 0xF4 && (data & 3) != 0) bmeMeasure();
+	}
+	return true;
+}
+
+
+static uint8_t bmeRead()
+{
+	return bmeRegs[bmePointer++];
+}
+
+
+static const SimI2cDevice bme280 = { BME_ADDR, bmeStart, bmeWrite, bmeRead };
+
+/// registers have their reset values before the node starts
+static struct BmeInit { 
+	BmeInit() { bmeReset(); simAddI2cDevice(&bme280); } 
+} bmeInit;
+
+#pragma endregion
@@ -0,0 +1,788 @@
+/**
+ * @file 		  SimCore.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Virtual time, I/O registers and the peripherals of the simulated
+ * ATmega328P: ports with the reed switch, Timer2 with watch crystal, ADC.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/twi.h>
+
+#include "SimCore.h"
+
+//===========================================================================
+#pragma region Registers
+
+SimReg8 PINB, DDRB, PORTB;
+SimReg8 PINC, DDRC, PORTC;
+SimReg8 PIND, DDRD, PORTD;
+SimReg8 SREG, SMCR, MCUCR, MCUSR, PRR, CLKPR, OSCCAL, GTCCR;
+SimReg8 EICRA, EIMSK, EIFR, PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+SimReg8 TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+SimReg8 TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+SimReg16 TCNT1, OCR1A, OCR1B, ICR1;
+SimReg8 TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2, ASSR;
+SimReg8 ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR1, ACSR;
+SimReg16 ADC;
+SimReg8 TWBR, TWSR, TWAR, TWDR, TWCR, TWAMR;
+SimReg8 EECR, EEDR, WDTCSR;
+SimReg16 EEAR;
+
+SimStats simStats;
+bool simDebug = false;
+double simLightLevel = 0.5;
+uint16_t simVccMillivolts = 3000;
+
+/// interrupt flags are cleared by writing a 1 to them
+static void clearOnWrite( SimReg8 &reg, uint8_t old )
+{
+	reg.value = old & ~reg.value;
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region Virtual time and interrupts
+
+static simtime_t now = 0;
+static bool sleeping = false;
+
+simtime_t simNow() { return now; }
+
+
+const char* simTimeString( simtime_t t )
+{
+	static char buf[32];
+	uint64_t ms = simTicksToMs(t);
+	unsigned d = (unsigned)(ms / 86400000uL);
+	ms %= 86400000uL;
+	snprintf(buf, sizeof(buf), "%ud %02u:%02u:%02u.%03u", d,
+		(unsigned)(ms / 3600000uL), (unsigned)(ms / 60000uL % 60u),
+		(unsigned)(ms / 1000u % 60u), (unsigned)(ms % 1000u) );
+	return buf;
+}
+
+
+void simCli() { SREG.value &= ~0x80; }
+void simSei() { SREG.value |= 0x80; }
+
+
+void simCallVector( void (*vector)(void) )
+{
+	uint8_t sreg = SREG.value;
+	SREG.value &= ~0x80;
+	simStats.interrupts++;
+	vector();
+	SREG.value = sreg | 0x80;
+}
+
+// vectors the firmware may or may not define
+extern "C" {
+	void simVector_INT0(void) __attribute__((weak));
+	void simVector_INT1(void) __attribute__((weak));
+	void simVector_PCINT2(void) __attribute__((weak));
+	void simVector_WDT(void) __attribute__((weak));
+	void simVector_TIMER2_COMPA(void) __attribute__((weak));
+	void simVector_TIMER2_OVF(void) __attribute__((weak));
+	void simVector_TIMER1_COMPA(void) __attribute__((weak));
+	void simVector_TIMER1_OVF(void) __attribute__((weak));
+	void simVector_ADC(void) __attribute__((weak));
+	void simVector_TWI(void) __attribute__((weak));
+}
+
+/// interrupt sources with a flag that is cleared when the vector executes, in priority order
+struct SimIrq {
+	SimReg8 *flags; uint8_t flagBit;
+	SimReg8 *mask;  uint8_t maskBit;
+	void (*vector)(void);
+	const char *name;
+};
+
+static const SimIrq irqs[] = {
+	{ &EIFR,   INTF0, &EIMSK,  INT0,   simVector_INT0, "INT0" },
+	{ &EIFR,   INTF1, &EIMSK,  INT1,   simVector_INT1, "INT1" },
+	{ &PCIFR,  PCIF2, &PCICR,  PCIE2,  simVector_PCINT2, "PCINT2" },
+	{ &WDTCSR, WDIF,  &WDTCSR, WDIE,   simVector_WDT, "WDT" },
+	{ &TIFR2,  OCF2A, &TIMSK2, OCIE2A, simVector_TIMER2_COMPA, "TIMER2_COMPA" },
+	{ &TIFR2,  TOV2,  &TIMSK2, TOIE2,  simVector_TIMER2_OVF, "TIMER2_OVF" },
+	{ &TIFR1,  OCF1A, &TIMSK1, OCIE1A, simVector_TIMER1_COMPA, "TIMER1_COMPA" },
+	{ &TIFR1,  TOV1,  &TIMSK1, TOIE1,  simVector_TIMER1_OVF, "TIMER1_OVF" },
+	{ &ADCSRA, ADIF,  &ADCSRA, ADIE,   simVector_ADC, "ADC" },
+	{ &TWCR,   TWINT, &TWCR,   TWIE,   simVector_TWI, "TWI" },
+};
+
+
+/**
+ * @brief Run ISRs for all pending and enabled interrupts.
+ * @return true if at least one ISR was run
+ */
+static bool servicePending()
+{
+	bool serviced = false;
+	bool again;
+	do {
+		again = false;
+		if (!(SREG.value & 0x80)) break;
+		for (const SimIrq &irq : irqs) {
+			if ((irq.flags->value & _BV(irq.flagBit)) && (irq.mask->value & _BV(irq.maskBit))) {
+				if (!irq.vector) {
+					fprintf(stderr, "%s: %s enabled, but no ISR defined\n", simTimeString(now), irq.name);
+					exit(2);
+				}
+				irq.flags->value &= ~_BV(irq.flagBit);
+				simCallVector(irq.vector);
+				serviced = again = true;
+				break;	// re-evaluate in priority order
+			}
+		}
+	} while (again);
+	return serviced;
+}
+
+
+static const SimEventSource* sources[16];
+static uint8_t nSources = 0;
+
+void simAddEventSource( const SimEventSource *src )
+{
+	if (nSources < sizeof(sources)/sizeof(sources[0]))
+		sources[nSources++] = src;
+}
+
+
+static simtime_t nextEvent()
+{
+	simtime_t t = SIM_FOREVER;
+	for (uint8_t i=0; i<nSources; i++)
+		t = std::min(t, sources[i]->next());
+	return t;
+}
+
+
+static void fireEvents( simtime_t t )
+{
+	now = t;
+	for (uint8_t i=0; i<nSources; i++)
+		if (sources[i]->next() == t)
+			sources[i]->fire(t);
+}
+
+
+void simAdvanceTo( simtime_t target )
+{
+	servicePending();
+	for (;;) {
+		simtime_t t = nextEvent();
+		if (t > target) break;
+		fireEvents(t);
+		servicePending();
+	}
+	if (target > now) now = target;
+}
+
+
+static void adcSleepStart();
+static void t1Sample();
+static int sleepMode();
+static bool twiActive();
+
+void simSleep()
+{
+	if (!(SMCR.value & _BV(SE))) return;	// SLEEP is a no-op unless enabled
+	if (!(SREG.value & 0x80)) {
+		fprintf(stderr, "%s: sleeping with interrupts disabled\n", simTimeString(now));
+		exit(2);
+	}
+	sleeping = true;
+	simtime_t t0 = now;
+	bool idle = (sleepMode() == SLEEP_MODE_IDLE);
+	if (!idle && twiActive()) {
+		fprintf(stderr, "%s: TWI transfer stalled, I/O clock stopped by sleep mode %d\n", 
+				simTimeString(now), sleepMode());
+		exit(2);
+	}
+	if ((SMCR.value & (_BV(SM0) | _BV(SM1) | _BV(SM2))) == SLEEP_MODE_ADC)
+		adcSleepStart();
+	while (!servicePending()) {
+		simtime_t t = nextEvent();
+		if (t == SIM_FOREVER) {
+			fprintf(stderr, "%s: sleeping forever, no wake-up source\n", simTimeString(now));
+			exit(2);
+		}
+		fireEvents(t);
+	}
+	sleeping = false;
+	if (idle) simStats.idleTime += now - t0;
+	t1Sample();				// I/O clock runs again
+	servicePending();		// an edge counted now may raise a Timer1 interrupt
+	simStats.wakeups++;
+}
+
+
+/// current sleep mode, or -1 if CPU is awake
+static int sleepMode()
+{
+	return sleeping ? (SMCR.value & (_BV(SM0) | _BV(SM1) | _BV(SM2))) : -1;
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region Reed switch and port pins
+
+struct TraceEntry { simtime_t t; bool closed; };
+
+/// a contact with its trace, contacts[0] is the gas meter reed switch
+struct SimContact
+{
+	SimSwitch sw;
+	std::vector<TraceEntry> trace;
+	simtime_t period;			// 0 if trace is not repeated
+};
+
+static std::vector<SimContact> contacts(1, SimContact{ { 0, 0, 0, 0 }, {}, 0 });
+
+
+static bool loadTrace( SimContact &c, const char *path, bool repeat )
+{
+	FILE *f = fopen(path, "r");
+	if (!f) { perror(path); return false; }
+
+	char line[128];
+	unsigned lineno = 0;
+	uint64_t tPrev = 0;
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		char *p = line + strspn(line, " \t");
+		if (*p=='#' || *p=='\n' || *p=='\r' || *p==0) continue;
+		bool relative = (*p=='+');
+		if (relative) p++;
+		char *end;
+		uint64_t ms = strtoull(p, &end, 10);
+		int state = (int)strtol(end, &end, 10);
+		if (end == p || (state != 0 && state != 1)) {
+			fprintf(stderr, "%s:%u: expected '[+]time_ms 0|1'\n", path, lineno);
+			fclose(f);
+			return false;
+		}
+		if (relative) ms += tPrev;
+		if (ms < tPrev) {
+			fprintf(stderr, "%s:%u: time goes backwards\n", path, lineno);
+			fclose(f);
+			return false;
+		}
+		tPrev = ms;
+		c.trace.push_back( TraceEntry{ simMsToTicks(ms), state==1 } );
+	}
+	fclose(f);
+	if (repeat && !c.trace.empty()) c.period = c.trace.back().t;
+	return true;
+}
+
+
+bool simLoadTrace( const char *path, bool repeat )
+{
+	return loadTrace(contacts[0], path, repeat);
+}
+
+
+void simAttachSwitch( const SimSwitch &sw )
+{
+	contacts[0].sw = sw;
+}
+
+
+bool simAddContact( const SimSwitch &sw, const char *path, bool repeat )
+{
+	SimContact c{ sw, {}, 0 };
+	if (!loadTrace(c, path, repeat)) return false;
+	contacts.push_back(c);
+	return true;
+}
+
+
+static bool contactClosed( const SimContact &c, simtime_t t )
+{
+	if (c.trace.empty()) return false;
+	if (c.period) t %= c.period;
+	auto it = std::upper_bound( c.trace.begin(), c.trace.end(), t,
+		[](simtime_t v, const TraceEntry &e) { return v < e.t; } );
+	if (it == c.trace.begin()) return false;
+	return (it-1)->closed;
+}
+
+
+bool simSwitchClosed( simtime_t t )
+{
+	return contactClosed(contacts[0], t);
+}
+
+
+static SimReg8& portReg( char port )
+{
+	return port=='B' ? PORTB : port=='C' ? PORTC : PORTD;
+}
+
+static SimReg8& ddrReg( char port )
+{
+	return port=='B' ? DDRB : port=='C' ? DDRC : DDRD;
+}
+
+
+/// time of the first entry in the trace of c after t, or SIM_FOREVER
+static simtime_t nextChange( const SimContact &c, simtime_t t )
+{
+	if (c.trace.empty()) return SIM_FOREVER;
+	simtime_t base = 0;
+	if (c.period) {
+		base = t - t % c.period;
+		t %= c.period;
+	}
+	auto it = std::upper_bound( c.trace.begin(), c.trace.end(), t,
+		[](simtime_t v, const TraceEntry &e) { return v < e.t; } );
+	if (it != c.trace.end()) return base + it->t;
+	if (!c.period) return SIM_FOREVER;
+	return base + c.period + c.trace.front().t;
+}
+
+
+/// time of the first change of any contact after t, or SIM_FOREVER
+static simtime_t nextTraceChange( simtime_t t )
+{
+	simtime_t tNext = SIM_FOREVER;
+	for (const SimContact &c : contacts)
+		tNext = std::min(tNext, nextChange(c, t));
+	return tNext;
+}
+
+
+/// number of trace entries of all contacts
+static size_t traceEntries()
+{
+	size_t n = 0;
+	for (const SimContact &c : contacts) n += c.trace.size();
+	return n;
+}
+
+
+/// is the pin actively pulled low by external circuitry at time t?
+static bool pulledLow( char port, uint8_t bit, simtime_t t )
+{
+	for (const SimContact &c : contacts) {
+		const SimSwitch &sw = c.sw;
+		if (sw.port != port || sw.bit != bit) continue;
+		if (!contactClosed(c, t)) continue;
+		if (!sw.retPort) return true;
+		if ((ddrReg(sw.retPort).value & _BV(sw.retBit))
+			&& !(portReg(sw.retPort).value & _BV(sw.retBit))) return true;
+	}
+	return false;
+}
+
+
+static uint8_t readPinAt( char port, simtime_t t )
+{
+	uint8_t ddr = ddrReg(port).value;
+	uint8_t out = portReg(port).value;
+	uint8_t pullup = (MCUCR.value & _BV(PUD)) ? 0 : (out & ~ddr);
+	uint8_t result = (out & ddr) | pullup;
+	for (uint8_t bit=0; bit<8; bit++)
+		if (!(ddr & _BV(bit)) && pulledLow(port,bit,t))
+			result &= ~_BV(bit);
+	return result;
+}
+
+static uint8_t readPin( char port ) { return readPinAt(port, now); }
+
+static uint8_t readPINB( const SimReg8& ) { return readPin('B'); }
+static uint8_t readPINC( const SimReg8& ) { return readPin('C'); }
+static uint8_t readPIND( const SimReg8& ) { return readPin('D'); }
+
+#pragma endregion
+//===========================================================================
+#pragma region External interrupts INT0, INT1
+
+/*
+	INT0 is PD2, INT1 is PD3. A LOW level interrupt is active as long as the 
+	pin is low, and can wake the CPU from any sleep mode. Edges are only 
+	detected while the I/O clock runs, i.e. awake or in SLEEP_MODE_IDLE.
+*/
+
+/// time at or after t when INTn condition is met, or SIM_FOREVER
+static simtime_t extIntNext( uint8_t n )
+{
+	if (!(EIMSK.value & _BV(n))) return SIM_FOREVER;
+	if (EIFR.value & _BV(n)) return SIM_FOREVER;		// already pending
+	uint8_t isc = (EICRA.value >> (2*n)) & 3;
+	uint8_t mask = _BV(2+n);
+	int mode = sleepMode();
+	if (isc != 0 && mode > 0) return SIM_FOREVER;		// no edge detection while I/O clock stopped
+
+	uint8_t level = readPinAt('D', now) & mask;
+	if (isc == 0 && !level) return now;
+	simtime_t t = now;
+	for (size_t i=0, n=traceEntries(); i<=n; i++) {
+		t = nextTraceChange(t);
+		if (t == SIM_FOREVER) break;
+		uint8_t nl = readPinAt('D', t) & mask;
+		bool hit = (isc == 0) ? !nl
+				 : (isc == 1) ? (nl != level)
+				 : (isc == 2) ? (level && !nl)
+				 :              (!level && nl);
+		if (hit) return t;
+		level = nl;
+	}
+	return SIM_FOREVER;
+}
+
+static simtime_t int0Next() { return extIntNext(INT0); }
+static simtime_t int1Next() { return extIntNext(INT1); }
+static void int0Fire( simtime_t ) { EIFR.value |= _BV(INTF0); }
+static void int1Fire( simtime_t ) { EIFR.value |= _BV(INTF1); }
+
+static const SimEventSource int0Source = { int0Next, int0Fire };
+static const SimEventSource int1Source = { int1Next, int1Fire };
+
+#pragma endregion
+//===========================================================================
+#pragma region Pin change interrupt 2 and Timer1 clocked from T1
+
+/*
+	Pin changes at PORTD are detected asynchronously, so PCINT2 can wake 
+	the CPU from any sleep mode. Timer1 with an external clock samples T1 
+	(PD5) with the I/O clock, so it only counts edges while the CPU is awake 
+	or in SLEEP_MODE_IDLE. The edge detector keeps the last sample while the 
+	clock is stopped, so an edge during power-save sleep is counted when 
+	the clock runs again. Both are evaluated whenever a contact changes.
+*/
+
+static uint8_t pcLevel = 0xFF;		// PIND & PCMSK2 at the last change
+static uint8_t t1Level = 1;			// T1 as last sampled by Timer1
+
+static bool t1External()
+{
+	return !(PRR.value & _BV(PRTIM1)) && (TCCR1B.value & _BV(CS12)) && (TCCR1B.value & _BV(CS11));
+}
+
+/// Timer1 samples T1, if the I/O clock runs
+static void t1Sample()
+{
+	if (!t1External() || sleepMode() > 0) return;
+	uint8_t level = (readPinAt('D', now) >> 5) & 1;
+	bool rising = (TCCR1B.value & _BV(CS10)) != 0;
+	if (level != t1Level && (level != 0) == rising) {
+		TCNT1.value++;
+		if (TCNT1.value == OCR1A.value) TIFR1.value |= _BV(OCF1A);
+		if (TCNT1.value == 0) TIFR1.value |= _BV(TOV1);
+	}
+	t1Level = level;
+}
+
+static simtime_t pcSeen = 0;		// contact changes up to this time have been evaluated
+
+static simtime_t pinChangeNext()
+{
+	if (!t1External() && !(PCICR.value & _BV(PCIE2))) return SIM_FOREVER;
+	// a change at the current time is still to come, unless it has been evaluated
+	simtime_t from = now ? now - 1 : 0;
+	return nextTraceChange(std::max(from, pcSeen));
+}
+
+static void pinChangeFire( simtime_t t )
+{
+	pcSeen = t;
+	uint8_t level = readPinAt('D', now) & PCMSK2.value;
+	if ((level != pcLevel) && (PCICR.value & _BV(PCIE2)))
+		PCIFR.value |= _BV(PCIF2);
+	pcLevel = level;
+	t1Sample();
+}
+
+static const SimEventSource pinChangeSource = { pinChangeNext, pinChangeFire };
+
+#pragma endregion
+//===========================================================================
+#pragma region Timer2 with 32768 Hz crystal
+
+/*
+	Timer2 is modelled in CTC mode (COMPA interrupt at OCR2A) and in
+	normal mode (OVF interrupt at 255). The time base is the crystal,
+	regardless of the AS2 bit.
+*/
+
+static simtime_t t2Base = 0;		// time at which TCNT2 had value t2Count
+static uint16_t t2Count = 0;
+
+static const uint16_t t2Prescalers[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+
+static uint16_t t2Prescaler()
+{
+	if (PRR.value & _BV(PRTIM2)) return 0;
+	return t2Prescalers[TCCR2B.value & 0x07];
+}
+
+static bool t2CTC() { return (TCCR2A.value & _BV(WGM21)) != 0; }
+static uint16_t t2Top() { return t2CTC() ? OCR2A.value : 255; }
+
+/// timer counts elapsed since t2Base, at given prescaler
+static uint16_t t2CountAt( simtime_t t, uint16_t ps )
+{
+	if (!ps) return t2Count;
+	uint64_t n = (t - t2Base) / ps;
+	uint16_t c = t2Count;
+	uint16_t top = t2Top();
+	if (c > top) {
+		uint16_t toWrap = 256 - c;
+		if (n < toWrap) return c + n;
+		n -= toWrap;
+		c = 0;
+	}
+	return (uint16_t)((c + n) % (top + 1u));
+}
+
+static uint16_t t2LastPrescaler = 0;
+
+/// re-base the model after a register write, using the old configuration up to now
+static void t2Resync()
+{
+	t2Count = t2CountAt(now, t2LastPrescaler);
+	t2Base = now;
+	t2LastPrescaler = t2Prescaler();
+}
+
+static void t2Write( SimReg8 &, uint8_t ) { t2Resync(); }
+
+// a write to TCCR2B or PRR is seen after the new value is stored, so sync with the old one
+static void t2WriteTCCR2B( SimReg8 &reg, uint8_t old )
+{
+	uint8_t nv = reg.value;
+	reg.value = old;
+	t2Resync();
+	reg.value = nv;
+	t2LastPrescaler = t2Prescaler();
+}
+
+static void t2WritePRR( SimReg8 &reg, uint8_t old )
+{
+	t2WriteTCCR2B(reg, old);
+}
+
+static void t2WriteTCNT2( SimReg8 &reg, uint8_t )
+{
+	t2Count = reg.value;
+	t2Base = now;
+	t2LastPrescaler = t2Prescaler();
+}
+
+// PSRASY resets the prescaler, so the next count is a full prescaler period away
+static void t2WriteGTCCR( SimReg8 &reg, uint8_t )
+{
+	if (reg.value & _BV(PSRASY)) {
+		t2Resync();
+		reg.value &= ~_BV(PSRASY);
+	}
+}
+
+static uint8_t t2ReadTCNT2( const SimReg8& )
+{
+	return (uint8_t)t2CountAt(now, t2Prescaler());
+}
+
+static simtime_t t2Next()
+{
+	uint16_t ps = t2Prescaler();
+	if (!ps) return SIM_FOREVER;
+	int mode = sleepMode();
+	if (mode == SLEEP_MODE_PWR_DOWN || mode == SLEEP_MODE_STANDBY) return SIM_FOREVER;
+	uint16_t top = t2Top();
+	uint32_t counts = (t2Count <= top) ? (top + 1u - t2Count) : (256u - t2Count + top + 1u);
+	return t2Base + (simtime_t)counts * ps;
+}
+
+static void t2Fire( simtime_t t )
+{
+	TIFR2.value |= t2CTC() ? _BV(OCF2A) : _BV(TOV2);
+	t2Base = t;
+	t2Count = 0;
+}
+
+static const SimEventSource timer2Source = { t2Next, t2Fire };
+
+#pragma endregion
+//===========================================================================
+#pragma region ADC
+
+/// input voltage at ADC channel, in mV
+static uint32_t adcInput( uint8_t channel )
+{
+	switch (channel) {
+		case 14:	return 1100;		// bandgap reference
+		case 15:	return 0;			// GND
+		case 2:		// LUX_SIGNAL, phototransistor between PC2 and GND, 100k to PC3
+			if ((DDRC.value & _BV(3)) && (PORTC.value & _BV(3)))
+				return (uint32_t)(simVccMillivolts * (1.0 - simLightLevel));
+			return 0;
+		default:	return 0;
+	}
+}
+
+static void adcWriteADCSRA( SimReg8 &reg, uint8_t old )
+{
+	// ADIF is cleared by writing a 1 to it
+	reg.value = (reg.value & ~_BV(ADIF)) | (old & ~reg.value & _BV(ADIF));
+
+	if (!(reg.value & _BV(ADSC))) return;
+	if (!(reg.value & _BV(ADEN)) || (PRR.value & _BV(PRADC))) return;
+
+	uint8_t refs = ADMUX.value >> REFS0;
+	uint32_t vref = (refs == 3) ? 1100 : simVccMillivolts;
+	uint32_t result = adcInput(ADMUX.value & 0x0F) * 1024u / vref;
+	ADC.value = (uint16_t)std::min<uint32_t>(result, 1023u);
+	reg.value = (reg.value & ~_BV(ADSC)) | _BV(ADIF);
+}
+
+/// entering SLEEP_MODE_ADC starts a conversion, unless one is running
+static void adcSleepStart()
+{
+	if ((ADCSRA.value & _BV(ADEN)) && !(ADCSRA.value & _BV(ADSC)))
+		ADCSRA = ADCSRA.value | _BV(ADSC);
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region TWI
+
+/*
+	The TWI master executes each action as soon as TWCR is written with 
+	TWINT set, i.e. transfers take no time, and sets TWINT and the status 
+	code in TWSR as the hardware does when it has finished.
+*/
+
+static const SimI2cDevice* i2cDevices[4];
+static uint8_t nI2cDevices = 0;
+static const SimI2cDevice* i2cSelected = NULL;	// addressed slave
+static bool twiAddressNext = false;				// TWDR holds SLA+R/W
+static bool twiBusTaken = false;				// between START and STOP
+static bool twiReading = false;
+
+/// between START and STOP, the TWI needs the I/O clock
+static bool twiActive()
+{
+	return twiBusTaken;
+}
+
+void simAddI2cDevice( const SimI2cDevice *dev )
+{
+	if (nI2cDevices < sizeof(i2cDevices)/sizeof(i2cDevices[0]))
+		i2cDevices[nI2cDevices++] = dev;
+}
+
+
+static void twiDone( SimReg8 &reg, uint8_t status )
+{
+	TWSR.value = (TWSR.value & 0x07) | status;
+	reg.value |= _BV(TWINT);
+}
+
+static void twiWriteTWCR( SimReg8 &reg, uint8_t old )
+{
+	// writing TWINT=1 clears the flag and starts the next action
+	if (!(reg.value & _BV(TWINT))) {
+		reg.value |= old & _BV(TWINT);
+		return;
+	}
+	reg.value &= ~_BV(TWINT);
+	if (!(reg.value & _BV(TWEN)) || (PRR.value & _BV(PRTWI))) return;
+
+	if (reg.value & _BV(TWSTO)) {
+		i2cSelected = NULL;
+		twiBusTaken = false;
+		reg.value &= ~_BV(TWSTO);
+	} else if (reg.value & _BV(TWSTA)) {
+		twiDone(reg, twiBusTaken ? TW_REP_START : TW_START);
+		twiBusTaken = true;
+		twiAddressNext = true;
+	} else if (twiAddressNext) {
+		twiAddressNext = false;
+		twiReading = TWDR.value & TW_READ;
+		i2cSelected = NULL;
+		for (uint8_t i=0; i<nI2cDevices; i++)
+			if (i2cDevices[i]->addr == (TWDR.value >> 1)) i2cSelected = i2cDevices[i];
+		if (i2cSelected) i2cSelected->start(twiReading);
+		if (twiReading)
+			twiDone(reg, i2cSelected ? TW_MR_SLA_ACK : TW_MR_SLA_NACK);
+		else
+			twiDone(reg, i2cSelected ? TW_MT_SLA_ACK : TW_MT_SLA_NACK);
+	} else if (!i2cSelected) {
+		twiDone(reg, TW_BUS_ERROR);
+	} else if (twiReading) {
+		TWDR.value = i2cSelected->read();
+		twiDone(reg, (reg.value & _BV(TWEA)) ? TW_MR_DATA_ACK : TW_MR_DATA_NACK);
+	} else {
+		twiDone(reg, i2cSelected->write(TWDR.value) ? TW_MT_DATA_ACK : TW_MT_DATA_NACK);
+	}
+}
+
+#pragma endregion
+//===========================================================================
+#pragma region Initialization
+
+struct SimCoreInit
+{
+	SimCoreInit()
+	{
+		PINB.onRead = readPINB;
+		PINC.onRead = readPINC;
+		PIND.onRead = readPIND;
+
+		EIFR.onWrite = clearOnWrite;
+		TIFR0.onWrite = clearOnWrite;
+		TIFR1.onWrite = clearOnWrite;
+		TIFR2.onWrite = clearOnWrite;
+		PCIFR.onWrite = clearOnWrite;
+
+		TCCR2A.onWrite = t2Write;
+		OCR2A.onWrite = t2Write;
+		TCCR2B.onWrite = t2WriteTCCR2B;
+		PRR.onWrite = t2WritePRR;
+		TCNT2.onWrite = t2WriteTCNT2;
+		TCNT2.onRead = t2ReadTCNT2;
+		GTCCR.onWrite = t2WriteGTCCR;
+		simAddEventSource(&timer2Source);
+
+		simAddEventSource(&int0Source);
+		simAddEventSource(&int1Source);
+		simAddEventSource(&pinChangeSource);
+
+		ADCSRA.onWrite = adcWriteADCSRA;
+		TWCR.onWrite = twiWriteTWCR;
+	}
+};
+
+static SimCoreInit simCoreInit;
+
+#pragma endregion
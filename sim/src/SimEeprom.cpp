@@ -0,0 +1,105 @@
+/**
+ * @file 		  SimEeprom.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief EEPROM of the simulated ATmega328P, optionally loaded from and 
+ * saved to a file, so a restart of the node (e.g. battery change) can be 
+ * simulated by running the program twice.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <avr/eeprom.h>
+
+#include "SimCore.h"
+
+uint8_t simEeprom[E2END+1];
+
+/// a new chip comes with erased EEPROM
+static struct EepromInit {
+	EepromInit() { memset(simEeprom, 0xFF, sizeof(simEeprom)); }
+} eepromInit;
+
+
+bool simLoadEeprom( const char *path )
+{
+	FILE *f = fopen(path, "rb");
+	if (!f) return false;		// no file yet: EEPROM is erased
+	size_t n = fread(simEeprom, 1, sizeof(simEeprom), f);
+	fclose(f);
+	return n == sizeof(simEeprom);
+}
+
+
+bool simSaveEeprom( const char *path )
+{
+	FILE *f = fopen(path, "wb");
+	if (!f) return false;
+	size_t n = fwrite(simEeprom, 1, sizeof(simEeprom), f);
+	fclose(f);
+	return n == sizeof(simEeprom);
+}
+
+
+static inline size_t index( const void *addr )
+{
+	return (size_t)(uintptr_t)addr & E2END;
+}
+
+
+uint8_t eeprom_read_byte( const uint8_t *addr )
+{
+	return simEeprom[index(addr)];
+}
+
+
+void eeprom_write_byte( uint8_t *addr, uint8_t value )
+{
+	simEeprom[index(addr)] = value;
+	simStats.eepromWrites++;
+}
+
+
+void eeprom_update_byte( uint8_t *addr, uint8_t value )
+{
+	if (simEeprom[index(addr)] != value)
+		eeprom_write_byte(addr, value);
+}
+
+
+void eeprom_read_block( void *dst, const void *src, size_t n )
+{
+	for (size_t i=0; i<n; i++)
+		((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+}
+
+
+void eeprom_write_block( const void *src, void *dst, size_t n )
+{
+	for (size_t i=0; i<n; i++)
+		eeprom_write_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+}
+
+
+void eeprom_update_block( const void *src, void *dst, size_t n )
+{
+	for (size_t i=0; i<n; i++)
+		eeprom_update_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file 		  SimMain.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief main() of the host-native simulation build.
+ *
+ * Runs the node firmware on a virtual clock, replaying a recorded reed switch
+ * trace, and logs every message the node sends or receives. At the end,
+ * prints statistics per simulated day, e.g.
+ *
+ *     .pio/build/native/program --trace sim/traces/winter_day.txt --repeat --days 7
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <MySensors.h>
+#include "SimCore.h"
+#include "pins.h"
+
+#define _SIM_PORT(port,bit,pol)	(#port[0])
+#define SIM_PORT(pin)			_SIM_PORT(pin)
+
+// functions defined by the node firmware
+void preHwInit();
+void setup();
+void loop();
+
+
+static void usage( const char *prog )
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --trace FILE       reed switch trace, lines of '[+]time_ms 0|1'\n"
+		"  --repeat           repeat trace, period is time of its last line\n"
+		"  --water FILE       water meter contact trace, for EXTRA_METERS\n"
+		"  --power FILE       S0 electricity meter trace, for EXTRA_METERS\n"
+		"  --t1 FILE          S0 electricity meter trace at T1, for T1_COUNTER\n"
+		"  --days N           simulated time in days (default 1)\n"
+		"  --hours N          simulated time in hours\n"
+		"  --base N           controller answers V_VAR1 request with N (default 0)\n"
+		"  --no-base          controller never answers V_VAR1 request\n"
+		"  --reply-delay MS   controller reply delay (default 200)\n"
+		"  --config TEXT      controller answers V_VAR4 request with TEXT\n"
+		"  --outage H1 H2     gateway unreachable from hour H1 to H2, may be repeated\n"
+		"  --lose SENSOR      messages of child SENSOR are never acknowledged, may be repeated\n"
+		"  --min-pa L         messages sent with RF24 PA level below L (0...3) are lost\n"
+		"  --light F          light level 0..1 (default 0.5)\n"
+		"  --vcc MV           battery voltage in mV (default 3000)\n"
+		"  --temp C           temperature at the BME280 in °C (default 20)\n"
+		"  --hum P            relative humidity at the BME280 in % (default 50)\n"
+		"  --eeprom FILE      load EEPROM from FILE if it exists, save it at the end\n"
+		"  --quiet            don't log messages, only print statistics\n"
+		"  --debug            show debug output of the node on stderr\n",
+		prog);
+	exit(1);
+}
+
+
+static void printStats( simtime_t duration )
+{
+	double days = (double)duration / (86400.0 * SIM_TICKS_PER_SECOND);
+	if (days <= 0) days = 1;
+	printf("# simulated  %s\n", simTimeString(duration));
+	printf("# wakeups    %12llu  %10.1f/day\n", (unsigned long long)simStats.wakeups, simStats.wakeups / days);
+	printf("# idle sleep %12.1f  %10.1f s/day\n", (double)simStats.idleTime / SIM_TICKS_PER_SECOND, 
+		   (double)simStats.idleTime / SIM_TICKS_PER_SECOND / days);
+	printf("# interrupts %12llu  %10.1f/day\n", (unsigned long long)simStats.interrupts, simStats.interrupts / days);
+	printf("# loop()     %12llu  %10.1f/day\n", (unsigned long long)simStats.loops, simStats.loops / days);
+	printf("# TX         %12llu  %10.1f/day\n", (unsigned long long)simStats.txMessages, simStats.txMessages / days);
+	printf("# TX failed  %12llu\n", (unsigned long long)simStats.txFailed);
+	printf("# RX         %12llu  %10.1f/day\n", (unsigned long long)simStats.rxMessages, simStats.rxMessages / days);
+	printf("# RX lost    %12llu\n", (unsigned long long)simStats.rxLost);
+	printf("# EEPROM     %12llu  %10.1f/day bytes written\n", (unsigned long long)simStats.eepromWrites, simStats.eepromWrites / days);
+}
+
+
+int main( int argc, char *argv[] )
+{
+	const char *tracePath = NULL;
+	const char *waterPath = NULL;
+	const char *powerPath = NULL;
+	const char *t1Path = NULL;
+	const char *eepromPath = NULL;
+	bool repeat = false;
+	bool quiet = false;
+	double hours = 24;
+
+	for (int i=1; i<argc; i++) {
+		const char *a = argv[i];
+		bool hasArg = (i+1 < argc);
+		if (!strcmp(a,"--trace") && hasArg)				tracePath = argv[++i];
+		else if (!strcmp(a,"--repeat"))					repeat = true;
+		else if (!strcmp(a,"--water") && hasArg)		waterPath = argv[++i];
+		else if (!strcmp(a,"--power") && hasArg)		powerPath = argv[++i];
+		else if (!strcmp(a,"--t1") && hasArg)			t1Path = argv[++i];
+		else if (!strcmp(a,"--days") && hasArg)			hours = 24 * atof(argv[++i]);
+		else if (!strcmp(a,"--hours") && hasArg)		hours = atof(argv[++i]);
+		else if (!strcmp(a,"--base") && hasArg)			simControllerBaseCount = atoll(argv[++i]);
+		else if (!strcmp(a,"--no-base"))				simControllerBaseCount = -1;
+		else if (!strcmp(a,"--reply-delay") && hasArg)	simControllerReplyDelay = (uint32_t)atol(argv[++i]);
+		else if (!strcmp(a,"--config") && hasArg)		simControllerConfig = argv[++i];
+		else if (!strcmp(a,"--outage") && i+2 < argc) {
+			double from = atof(argv[++i]), to = atof(argv[++i]);
+			simAddOutage((simtime_t)(from * 3600.0 * SIM_TICKS_PER_SECOND), 
+						 (simtime_t)(to * 3600.0 * SIM_TICKS_PER_SECOND));
+		}
+		else if (!strcmp(a,"--lose") && hasArg)			simLoseSensor((uint8_t)atoi(argv[++i]));
+		else if (!strcmp(a,"--min-pa") && hasArg)		simMinPaLevel = (uint8_t)atoi(argv[++i]);
+		else if (!strcmp(a,"--light") && hasArg)		simLightLevel = atof(argv[++i]);
+		else if (!strcmp(a,"--vcc") && hasArg)			simVccMillivolts = (uint16_t)atoi(argv[++i]);
+		else if (!strcmp(a,"--temp") && hasArg)			simTemperature = atof(argv[++i]);
+		else if (!strcmp(a,"--hum") && hasArg)			simHumidity = atof(argv[++i]);
+		else if (!strcmp(a,"--eeprom") && hasArg)		eepromPath = argv[++i];
+		else if (!strcmp(a,"--quiet"))					quiet = true;
+		else if (!strcmp(a,"--debug"))					simDebug = true;
+		else usage(argv[0]);
+	}
+
+	if (tracePath && !simLoadTrace(tracePath, repeat)) return 1;
+	if (eepromPath) simLoadEeprom(eepromPath);
+	SimSwitch sw = { SIM_PORT(MAGNET), portBIT(MAGNET), SIM_PORT(MAGNET_RET), portBIT(MAGNET_RET) };
+	simAttachSwitch(sw);
+	// the other meters share the return pin with the gas meter
+	SimSwitch water = { SIM_PORT(WATER_METER), portBIT(WATER_METER), SIM_PORT(MAGNET_RET), portBIT(MAGNET_RET) };
+	if (waterPath && !simAddContact(water, waterPath, repeat)) return 1;
+	SimSwitch power = { SIM_PORT(POWER_METER), portBIT(POWER_METER), SIM_PORT(MAGNET_RET), portBIT(MAGNET_RET) };
+	if (powerPath && !simAddContact(power, powerPath, repeat)) return 1;
+	SimSwitch t1 = { SIM_PORT(PULSE_T1), portBIT(PULSE_T1), 0, 0 };
+	if (t1Path && !simAddContact(t1, t1Path, repeat)) return 1;
+
+	simLogMessages = !quiet;
+
+	simtime_t end = (simtime_t)(hours * 3600.0 * SIM_TICKS_PER_SECOND);
+
+	// same sequence as MySensors on AVR
+	preHwInit();
+	presentation();
+	setup();
+	while (simNow() < end) {
+		_process();
+		loop();
+		simStats.loops++;
+	}
+
+	printStats(simNow());
+	if (eepromPath && !simSaveEeprom(eepromPath)) {
+		fprintf(stderr, "can't write %s\n", eepromPath);
+		return 1;
+	}
+	return 0;
+}
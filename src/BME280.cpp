@@ -0,0 +1,169 @@
+/**
+ * @file 		  BME280.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Lean BME280 driver, temperature and humidity only, see BME280.h.
+ * Compensation formulas are from the BME280 datasheet, section 4.2.3 and 8.2.
+ */
+
+#include <stdint.h>
+
+#include "Twi.h"
+#include "BME280.h"
+
+#define REG_CALIB_T		0x88		// dig_T1 ... dig_T3
+#define REG_CALIB_H1	0xA1		// dig_H1
+#define REG_CHIP_ID		0xD0
+#define REG_CALIB_H2	0xE1		// dig_H2 ... dig_H6
+#define REG_CTRL_HUM	0xF2
+#define REG_CTRL_MEAS	0xF4
+#define REG_CONFIG		0xF5
+#define REG_TEMP		0xFA		// temp_msb, temp_lsb, temp_xlsb, hum_msb, hum_lsb
+
+#define CHIP_ID			0x60
+#define OSRS_X1			1
+#define MODE_FORCED		1
+#define CTRL_MEAS		((OSRS_X1 << 5) | (0 << 2) | MODE_FORCED)	// T x1, no pressure
+#define ADC_SKIPPED		0x80000		// temperature reading if no measurement
+
+
+/// result of the ctrl_meas write started by startForced()
+static volatile uint8_t startStatus = TWI_ERROR;
+
+static void startDone( uint8_t status )
+{
+	startStatus = status;
+}
+
+
+void BME280::write8( uint8_t reg, uint8_t value )
+{
+	uint8_t b[2] = { reg, value };
+	twiTransfer(_addr, b, sizeof(b), 0, 0);
+}
+
+
+bool BME280::readBlock( uint8_t reg, uint8_t *buf, uint8_t len )
+{
+	return twiTransfer(_addr, &reg, 1, buf, len) == TWI_OK;
+}
+
+
+/**
+ * @brief Check chip ID, read calibration data, configure for forced mode.
+ *
+ * @param addr 	I2C address, 0x76 or 0x77
+ * @return true if a BME280 was found
+ */
+bool BME280::begin( uint8_t addr )
+{
+	uint8_t b[7];
+
+	_addr = addr;
+	if (!readBlock(REG_CHIP_ID, b, 1) || b[0] != CHIP_ID) return false;
+
+	if (!readBlock(REG_CALIB_T, b, 6)) return false;
+	_calib.T1 = b[0] | (b[1] << 8);
+	_calib.T2 = (int16_t)(b[2] | (b[3] << 8));
+	_calib.T3 = (int16_t)(b[4] | (b[5] << 8));
+	if (!readBlock(REG_CALIB_H1, b, 1)) return false;
+	_calib.H1 = b[0];
+	if (!readBlock(REG_CALIB_H2, b, 7)) return false;
+	_calib.H2 = (int16_t)(b[0] | (b[1] << 8));
+	_calib.H3 = b[2];
+	_calib.H4 = (int16_t)(((int8_t)b[3] << 4) | (b[4] & 0x0F));
+	_calib.H5 = (int16_t)(((int8_t)b[5] << 4) | (b[4] >> 4));
+	_calib.H6 = (int8_t)b[6];
+
+	write8(REG_CTRL_HUM, OSRS_X1);		// takes effect with next write to ctrl_meas
+	write8(REG_CONFIG, 0);				// no filter
+	return true;
+}
+
+
+/**
+ * @brief Start one measurement, results are available after ~10ms.
+ * Only starts the I2C transfer, which completes while the CPU sleeps.
+ */
+void BME280::startForced()
+{
+	static const uint8_t cmd[2] = { REG_CTRL_MEAS, CTRL_MEAS };
+	twiWait();
+	startStatus = TWI_ERROR;
+	twiStart(_addr, cmd, sizeof(cmd), 0, 0, startDone);
+}
+
+
+/**
+ * @brief Read results of the last measurement, in one burst.
+ *
+ * @param temperature 	set to temperature in 0.01°C
+ * @param humidity 		set to relative humidity in 0.01%
+ * @return true if successful
+ */
+bool BME280::read( int16_t &temperature, uint16_t &humidity )
+{
+	uint8_t b[5];
+	int32_t t_fine;
+
+	twiWait();
+	if (startStatus != TWI_OK) return false;		// measurement was not started
+	if (!readBlock(REG_TEMP, b, sizeof(b))) return false;
+	int32_t adcT = ((uint32_t)b[0] << 12) | ((uint16_t)b[1] << 4) | (b[2] >> 4);
+	int32_t adcH = ((uint16_t)b[3] << 8) | b[4];
+	if (adcT == ADC_SKIPPED) return false;
+
+	temperature = compensateT(_calib, adcT, t_fine);
+	// Q22.10 %RH to 0.01%
+	humidity = (compensateH(_calib, adcH, t_fine) * 100u + 512u) >> 10;
+	return true;
+}
+
+
+/**
+ * @brief Temperature in 0.01°C, from datasheet BME280_compensate_T_int32()
+ *
+ * @param t_fine 	set to fine temperature, for compensateH()
+ */
+int32_t BME280::compensateT( const BME280Calib &c, int32_t adc, int32_t &t_fine )
+{
+	int32_t var1 = ((((adc >> 3) - ((int32_t)c.T1 << 1))) * ((int32_t)c.T2)) >> 11;
+	int32_t var2 = (((((adc >> 4) - ((int32_t)c.T1)) * ((adc >> 4) - ((int32_t)c.T1))) >> 12) 
+					* ((int32_t)c.T3)) >> 14;
+	t_fine = var1 + var2;
+	return (t_fine * 5 + 128) >> 8;
+}
+
+
+/**
+ * @brief Relative humidity in %, Q22.10, from datasheet bme280_compensate_H_int32()
+ */
+uint32_t BME280::compensateH( const BME280Calib &c, int32_t adc, int32_t t_fine )
+{
+	int32_t v = t_fine - (int32_t)76800;
+	v = (((((adc << 14) - (((int32_t)c.H4) << 20) - (((int32_t)c.H5) * v)) 
+			+ ((int32_t)16384)) >> 15) 
+		* (((((((v * ((int32_t)c.H6)) >> 10) * (((v * ((int32_t)c.H3)) >> 11) 
+			+ ((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)c.H2) + 8192) >> 14));
+	v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)c.H1)) >> 4);
+	if (v < 0) v = 0;
+	if (v > 419430400) v = 419430400;
+	return (uint32_t)(v >> 12);
+}
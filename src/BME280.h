@@ -0,0 +1,63 @@
+/**
+ * @file 		  BME280.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _BME280_H
+#define _BME280_H
+
+#include <stdint.h>
+
+/// calibration data for temperature and humidity, from the sensor's NVM
+struct BME280Calib
+{
+	uint16_t T1;
+	int16_t T2, T3;
+	uint8_t H1;
+	int16_t H2;
+	uint8_t H3;
+	int16_t H4, H5;
+	int8_t H6;
+};
+
+/**
+ * @brief Minimal BME280 driver for temperature and humidity, in forced mode, 
+ * with 1x oversampling, no pressure, no filter. 
+ *
+ * Integer only: uses the fixed-point compensation formulas from the Bosch 
+ * datasheet, and reads all measurement registers in one I2C burst.
+ */
+class BME280
+{
+	public:
+		bool begin( uint8_t addr );
+		void startForced();
+		bool read( int16_t &temperature, uint16_t &humidity );
+
+		static int32_t compensateT( const BME280Calib &c, int32_t adc, int32_t &t_fine );
+		static uint32_t compensateH( const BME280Calib &c, int32_t adc, int32_t t_fine );
+
+	private:
+		void write8( uint8_t reg, uint8_t value );
+		bool readBlock( uint8_t reg, uint8_t *buf, uint8_t len );
+
+		uint8_t _addr;
+		BME280Calib _calib;
+};
+
+#endif // _BME280_H
@@ -104,12 +104,81 @@ void basicHwInit()
 }
 
 
+/*
+	RAM between the end of the heap and the stack is filled with a pattern 
+	at boot. The stack grows down into it, the heap (if malloc() is used 
+	at all) grows up into it, and whatever is still unchanged later has 
+	never been used. No stack model in the host-native simulation, there 
+	the functions return 0.
+*/
+
+#define RAM_PATTERN	0xC5		// unlikely as a return address or counter
+#define RAM_MARGIN	16			// don't paint the bytes right below the stack pointer
+
+#ifdef __AVR__
+extern uint8_t __heap_start;	// end of .bss, from linker script
+extern void *__brkval;			// end of heap, or 0 if malloc() not used yet
+
+static inline uint8_t* heapEnd()
+{
+	return __brkval ? (uint8_t*)__brkval : &__heap_start;
+}
+#endif
+
+
+/**
+ * @brief Fill free RAM between heap and stack with a pattern, see ramNeverUsed().
+ * Called from basicSetup(), the earlier, the better.
+ */
+void basicPaintRam()
+{
+#ifdef __AVR__
+	uint8_t *p = heapEnd();
+	uint8_t *end = (uint8_t*)SP - RAM_MARGIN;
+	while (p < end) *p++ = RAM_PATTERN;
+#endif
+}
+
+
+/**
+ * @brief Bytes between heap and stack right now.
+ */
+uint16_t ramFree()
+{
+#ifdef __AVR__
+	return (uint8_t*)SP - heapEnd();
+#else
+	return 0;
+#endif
+}
+
+
+/**
+ * @brief Bytes between heap and stack that have never been used since 
+ * basicPaintRam(), i.e. the headroom left at the deepest point of the stack.
+ */
+uint16_t ramNeverUsed()
+{
+#ifdef __AVR__
+	const uint8_t *start = heapEnd();
+	const uint8_t *p = start;
+	const uint8_t *end = (uint8_t*)SP;
+	while (p < end && *p == RAM_PATTERN) p++;
+	return p - start;
+#else
+	return 0;
+#endif
+}
+
+
 /**
  * @brief Basic things to do in setup().
  * 
  */
 void basicSetup()
 {
+	basicPaintRam();
+
 	#ifdef SOFT_1MHZ
 	  DEBUG_PRINT("* Soft 1 MHz\r\n");
 	#endif
@@ -1,7 +1,12 @@
 #ifndef _BASICS_H
 #define _BASICS_H
 
+#include <stdint.h>
+
 void basicHwInit();
 void basicSetup();
+void basicPaintRam();
+uint16_t ramFree();
+uint16_t ramNeverUsed();
 
 #endif // _BASICS_H
@@ -0,0 +1,108 @@
+/**
+ * @file 		  BurnerStats.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Burner cycle statistics from gas meter pulses, see BurnerStats.h
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "BurnerStats.h"
+
+
+/**
+ * @brief Start a new period. A cycle in progress continues.
+ */
+void BurnerStats::clear()
+{
+	_cycles = 0;
+	_short = 0;
+	_onTime = 0;
+	_pulses = 0;
+	_minInterval = UINT32_MAX;
+}
+
+
+/**
+ * @brief Add a gas meter pulse.
+ *
+ * @param t 	time of pulse, in ms
+ */
+void BurnerStats::pulse( uint32_t t )
+{
+	if (_open) {
+		uint32_t dt = t - _tLast;
+		if (dt < BURNER_GAP) {
+			if (dt > 0 && dt < _minInterval) _minInterval = dt;
+			_tLast = t;
+			_n++;
+			return;
+		}
+		close();
+	}
+	_open = true;
+	_tFirst = _tLast = t;
+	_n = 1;
+}
+
+
+/**
+ * @brief The cycle in progress has ended, add it to the statistics.
+ */
+void BurnerStats::close()
+{
+	uint32_t duration = 0;
+	if (_n > 1) duration = (_tLast - _tFirst) / (_n - 1) * _n;
+	_cycles++;
+	if (duration < SHORT_CYCLE) _short++;
+	_onTime += duration;
+	_pulses += _n;
+	_open = false;
+}
+
+
+/**
+ * @brief Format statistics of the current period as text, 
+ *   "<cycles>,<short cycles>,<mean minutes>,<mean liters>,<peak l/h>"
+ * which takes at most 25 characters if there can't be more than 999 cycles.
+ *
+ * @param now 				current time in ms, to end a cycle without pulses since BURNER_GAP
+ * @param litersPerClick 	gas volume per pulse
+ * @param buf 				buffer for text
+ * @param size 				size of buffer
+ * @return length of text
+ */
+uint8_t BurnerStats::format( uint32_t now, uint16_t litersPerClick, char *buf, uint8_t size )
+{
+	if (_open && (uint32_t)(now - _tLast) >= BURNER_GAP) close();
+
+	uint32_t minutes = 0, liters = 0, peak = 0;
+	if (_cycles) {
+		minutes = (_onTime / _cycles + 30000uL) / 60000uL;
+		liters = (_pulses * litersPerClick + _cycles/2) / _cycles;
+	}
+	if (_minInterval != UINT32_MAX) {
+		peak = (litersPerClick * 3600000uL) / _minInterval;
+		if (peak > 0xFFFF) peak = 0xFFFF;
+	}
+	int n = snprintf(buf, size, "%u,%u,%lu,%lu,%lu", _cycles, _short, minutes, liters, peak);
+	return (n < 0) ? 0 : (n >= size) ? size-1 : n;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file 		  BurnerStats.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _BURNERSTATS_H
+#define _BURNERSTATS_H
+
+#include <stdint.h>
+
+#define BURNER_GAP		300000uL		// ms without pulse that end a burner cycle, like FLOW_TIMEOUT
+#define SHORT_CYCLE		600000uL		// cycles shorter than this (ms) count as short cycles
+
+/**
+ * @brief Burner cycles, detected from the gas meter pulses alone.
+ *
+ * A cycle starts with a pulse after a pause of at least BURNER_GAP, and 
+ * ends with the last pulse before the next such pause. The first pulse 
+ * of a cycle comes about one pulse interval after the burner has started, 
+ * so the duration is estimated as (last - first) * n / (n-1) for n pulses. 
+ * A cycle of a single pulse has unknown duration, and counts as 0.
+ *
+ * Cycles are added to the statistics of the current period when they 
+ * have ended, so a cycle that is still going on when the period ends
+ * belongs to the next period.
+ */
+class BurnerStats
+{
+	public:
+		BurnerStats() : _open(false) { clear(); }
+
+		void pulse( uint32_t t );
+		uint8_t format( uint32_t now, uint16_t litersPerClick, char *buf, uint8_t size );
+		void clear();
+
+	private:
+		void close();
+
+		// cycle in progress
+		bool _open;					///< a cycle has started, and not ended yet
+		uint32_t _tFirst;			///< time of first pulse of the cycle
+		uint32_t _tLast;			///< time of most recent pulse
+		uint16_t _n;				///< number of pulses in the cycle
+		// statistics of the current period
+		uint16_t _cycles;			///< number of cycles that have ended
+		uint16_t _short;			///< of those, shorter than SHORT_CYCLE
+		uint32_t _onTime;			///< sum of cycle durations, in ms
+		uint32_t _pulses;			///< sum of pulses in cycles
+		uint32_t _minInterval;		///< shortest time between two pulses, in ms
+};
+
+#endif // _BURNERSTATS_H
@@ -0,0 +1,127 @@
+/**
+ * @file 		  Deadlines.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Deadline queue for the periodic reporting tasks, so the node only 
+ * wakes up from sleep when there is something to do.
+ *
+ * When at least one task is due, all other tasks that would be due within 
+ * a slack window run in the same wake period, so they share one power-up 
+ * of the radio.
+ */
+
+#include <stdint.h>
+
+#include "Deadlines.h"
+
+
+/**
+ * @brief Set (or move) the deadline of a task.
+ *
+ * @param id 	task number 0 ... MAX_DEADLINES-1, lower runs first
+ * @param task 	function to call when due
+ * @param due 	time in ms, as returned by timer2.get_millis()
+ * @param early if false, task will not be run ahead of time with others
+ */
+void Deadlines::schedule( uint8_t id, task_t task, uint32_t due, bool early )
+{
+	uint8_t mask = 1u << id;
+	_task[id] = task;
+	_due[id] = due;
+	_active |= mask;
+	if (early) _exact &= ~mask; else _exact |= mask;
+}
+
+
+/**
+ * @brief Set the deadline of a task, unless it is already scheduled earlier.
+ *
+ * Parameters as for schedule()
+ */
+void Deadlines::advance( uint8_t id, task_t task, uint32_t due, bool early )
+{
+	if (pending(id) && (int32_t)(_due[id] - due) <= 0) return;
+	schedule(id, task, due, early);
+}
+
+
+/**
+ * @brief Remove the deadline of a task, if any.
+ */
+void Deadlines::cancel( uint8_t id )
+{
+	_active &= ~(1u << id);
+}
+
+
+/**
+ * @brief Find the earliest deadline.
+ *
+ * @param due 	set to the earliest deadline, if any
+ * @return true if any task is scheduled
+ */
+bool Deadlines::next( uint32_t &due ) const
+{
+	bool found = false;
+	for (uint8_t id=0; id<MAX_DEADLINES; id++) {
+		if (!(_active & (1u << id))) continue;
+		if (!found || (int32_t)(_due[id] - due) < 0) {
+			due = _due[id];
+			found = true;
+		}
+	}
+	return found;
+}
+
+
+/**
+ * @brief Run all tasks that are due, plus those due within `slack` ms, 
+ * but only if at least one task is actually due.
+ * Tasks scheduled while running will be run by the next call, at the earliest.
+ *
+ * @param now 	current time in ms
+ * @param slack how far ahead to run tasks, in ms
+ * @return number of tasks run
+ */
+uint8_t Deadlines::run( uint32_t now, uint32_t slack )
+{
+	uint8_t due = 0, soon = 0;
+	for (uint8_t id=0; id<MAX_DEADLINES; id++) {
+		uint8_t mask = 1u << id;
+		if (!(_active & mask)) continue;
+		int32_t dt = (int32_t)(_due[id] - now);
+		if (dt <= 0) 
+			due |= mask;
+		else if (dt <= (int32_t)slack && !(_exact & mask)) 
+			soon |= mask;
+	}
+	if (!due) return 0;
+	due |= soon;
+
+	uint8_t n = 0;
+	for (uint8_t id=0; id<MAX_DEADLINES; id++) {
+		uint8_t mask = 1u << id;
+		if (!(due & mask)) continue;
+		_active &= ~mask;
+		_task[id](_due[id]);
+		n++;
+	}
+	return n;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file 		  Deadlines.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _DEADLINES_H
+#define _DEADLINES_H
+
+#include <stdint.h>
+
+#define MAX_DEADLINES	8
+
+/**
+ * @brief A small, fixed set of tasks, each with at most one pending deadline
+ * in milliseconds.
+ *
+ * Tasks are identified by a small number, which is also their priority:
+ * tasks that are due at the same time run in order of their id.
+ * All times are compared modulo 2^32, so deadlines must be less than 
+ * ~24 days in the future.
+ */
+class Deadlines
+{
+	public:
+		/// a task is called with the time it was scheduled for
+		typedef void (*task_t)( uint32_t due );
+
+		void schedule( uint8_t id, task_t task, uint32_t due, bool early=true );
+		void advance( uint8_t id, task_t task, uint32_t due, bool early=true );
+		void cancel( uint8_t id );
+		bool pending( uint8_t id ) const { return _active & (1u << id); }
+		bool next( uint32_t &due ) const;
+		uint8_t run( uint32_t now, uint32_t slack );
+
+	private:
+		task_t _task[MAX_DEADLINES];
+		uint32_t _due[MAX_DEADLINES];
+		uint8_t _active;			// bit n set if task n is scheduled
+		uint8_t _exact;				// bit n set if task n must not run early
+};
+
+#endif // _DEADLINES_H
@@ -0,0 +1,65 @@
+/**
+ * @file 		  Debouncer.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _DEBOUNCER_H
+#define _DEBOUNCER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Debouncer for up to 8 contacts on one port, which are sampled 
+ * together, periodically. Small enough to be inlined into the sampling ISR.
+ *
+ * Each contact has a 2-bit counter of consecutive samples that differ from 
+ * its debounced state, and the state changes at the 4th such sample. 
+ * That is the same rule as in my Button library, but the counters are kept 
+ * "vertically", bit 0 of all counters in `ct0` and bit 1 in `ct1`, so a few 
+ * logic operations count, reset and toggle all contacts at once, whatever 
+ * their number. Only to be used from one ISR, so nothing is volatile.
+ */
+class Debouncer
+{
+	public:
+		Debouncer() : state(0), ct0(0xFF), ct1(0xFF) {}
+
+		/**
+		 * @brief Add one sample of all contacts.
+		 *
+		 * @param down 	bit set if that contact is closed
+		 * @return bits of the contacts whose debounced state has changed
+		 */
+		uint8_t tick( uint8_t down )
+		{
+			uint8_t i = state ^ down;		// differs from debounced state
+			ct0 = ~(ct0 & i);				// count down if different,
+			ct1 = ct0 ^ (ct1 & i);			// else reset to 3
+			i &= ct0 & ct1;					// counted down past 0
+			state ^= i;
+			return i;
+		}
+
+		uint8_t state;		///< debounced state, bit set if contact closed
+
+	private:
+		uint8_t ct0;		///< bit 0 of each counter
+		uint8_t ct1;		///< bit 1 of each counter
+};
+
+#endif // _DEBOUNCER_H
@@ -0,0 +1,135 @@
+/**
+ * @file 		  EnergyStats.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Energy accounting: CPU cycles per section of code, measured with 
+ * Timer1, radio on time and message count, see EnergyStats.h
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "EnergyStats.h"
+
+
+/**
+ * @brief Start Timer1 as a free-running cycle counter.
+ */
+void EnergyStats::begin()
+{
+	memset(this, 0, sizeof(*this));
+	_radio = true;						// radio is on after startup
+	PRR &= ~_BV(PRTIM1);
+	TCCR1A = 0;							// normal mode
+	TCCR1B = _BV(CS10);					// clk/1
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TIMSK1 = _BV(TOIE1);
+}
+
+
+/**
+ * @brief CPU cycles while awake, since begin().
+ * Wraps after 2^32 cycles, i.e. ~9 min awake time at 8 MHz.
+ */
+uint32_t EnergyStats::now()
+{
+	uint8_t sreg = SREG;
+	cli();
+	uint16_t lo = TCNT1;
+	uint16_t hi = _overflows;
+	// overflow that happened since interrupts were disabled
+	if ((TIFR1 & _BV(TOV1)) && lo < 0x8000) hi++;
+	SREG = sreg;
+	return ((uint32_t)hi << 16) | lo;
+}
+
+
+/**
+ * @brief Radio has been turned on (if it wasn't on already).
+ *
+ * @param ms 	current time in ms
+ */
+void EnergyStats::radioOn( uint32_t ms )
+{
+	if (_radio) return;
+	_radio = true;
+	_tRadioOn = ms;
+}
+
+
+/**
+ * @brief Radio has been turned off.
+ *
+ * @param ms 	current time in ms
+ */
+void EnergyStats::radioOff( uint32_t ms )
+{
+	if (!_radio) return;
+	_radio = false;
+	_radioMs += ms - _tRadioOn;
+}
+
+
+/**
+ * @brief Time spent in one section, in ms.
+ */
+uint32_t EnergyStats::millis( uint8_t section ) const
+{
+	return _cycles[section] / (F_CPU / 1000uL);
+}
+
+
+/**
+ * @brief Format statistics as two texts for MySensors messages, 
+ * "C <isr>,<loop>,<adc>,<i2c>,<serial>" with CPU time in ms, and
+ * "R <on>,<tx>,<failed>" with radio on time in ms and number of messages.
+ *
+ * @param ms 	current time in ms, to include the current radio on time
+ * @param cpu 	buffer for CPU statistics
+ * @param radio buffer for radio statistics
+ * @param size 	size of each buffer
+ */
+void EnergyStats::format( uint32_t ms, char *cpu, char *radio, uint8_t size )
+{
+	snprintf(cpu, size, "C %lu,%lu,%lu,%lu,%lu", 
+		(unsigned long)millis(ES_ISR), (unsigned long)millis(ES_LOOP),
+		(unsigned long)millis(ES_ADC), (unsigned long)millis(ES_I2C), 
+		(unsigned long)millis(ES_SERIAL));
+	uint32_t on = _radioMs + (_radio ? ms - _tRadioOn : 0);
+	snprintf(radio, size, "R %lu,%u,%u", (unsigned long)on, _tx, _txFailed);
+}
+
+
+/**
+ * @brief Start a new reporting period.
+ *
+ * @param ms 	current time in ms
+ */
+void EnergyStats::clear( uint32_t ms )
+{
+	memset(_cycles, 0, sizeof(_cycles));
+	_radioMs = 0;
+	_tRadioOn = ms;
+	_tx = _txFailed = 0;
+}
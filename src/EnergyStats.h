@@ -0,0 +1,75 @@
+/**
+ * @file 		  EnergyStats.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _ENERGYSTATS_H
+#define _ENERGYSTATS_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/// what the CPU was doing while awake
+enum EnergySection {
+	ES_ISR,			///< Timer2 and INT1 interrupts
+	ES_LOOP,		///< loop(), including ADC and I2C below
+	ES_ADC,			///< light and battery measurement
+	ES_I2C,			///< BME280 access
+	ES_SERIAL,		///< waiting in Serial.flush()
+	ES_SECTIONS
+};
+
+/**
+ * @brief Where the battery goes: CPU cycles per section of code, 
+ * time the radio was on, and number of messages sent.
+ *
+ * Timer1 counts CPU cycles. Like the CPU clock, it stops in 
+ * SLEEP_MODE_PWR_SAVE, so it only counts while the CPU is awake, and 
+ * cycles spent in a section are the difference of two readings.
+ */
+class EnergyStats
+{
+	public:
+		void begin();
+		uint32_t now();
+		/// add cycles since `start` to a section
+		void add( uint8_t section, uint32_t start ) { _cycles[section] += now() - start; }
+		/// cheaper version for an ISR, which is always shorter than 2^16 cycles.
+		/// Timer1 runs from the prescaled clock too, scale to cycles at F_CPU
+		void addISR( uint16_t start ) { _cycles[ES_ISR] += (uint32_t)(uint16_t)(TCNT1 - start) << (CLKPR & 0x0F); }
+		void radioOn( uint32_t ms );
+		void radioOff( uint32_t ms );
+		void tx() { _tx++; }
+		void txFailed() { _txFailed++; }
+		/// call from Timer1 overflow ISR
+		void overflow() { _overflows++; }
+		uint32_t millis( uint8_t section ) const;
+		void format( uint32_t ms, char *cpu, char *radio, uint8_t size );
+		void clear( uint32_t ms );
+
+	private:
+		volatile uint16_t _overflows;	// upper 16 bits of cycle count
+		uint32_t _cycles[ES_SECTIONS];
+		uint32_t _radioMs;			// radio on, in ms
+		uint32_t _tRadioOn;			// time radio was turned on
+		bool _radio;				// radio is on
+		uint16_t _tx;				// messages sent
+		uint16_t _txFailed;			// messages not acknowledged
+};
+
+#endif // _ENERGYSTATS_H
@@ -0,0 +1,159 @@
+/**
+ * @file 		  History.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Store-and-forward history of hourly pulse counts, see History.h
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "History.h"
+
+#define WIDE		0x80		// 10xxxxxx: 2-byte count
+#define GAP			0xC0		// 11xxxxxx: gap
+#define TAG_MASK	0xC0
+#define MAX_GAP		64
+
+
+void History::push( uint8_t b )
+{
+	_buf[(uint8_t)((_head + _len) % HISTORY_SIZE)] = b;
+	_len++;
+}
+
+
+void History::pop( uint8_t n )
+{
+	_head = (uint8_t)((_head + n) % HISTORY_SIZE);
+	_len -= n;
+}
+
+
+/**
+ * @brief Remove oldest count, and any gaps that follow it
+ */
+void History::dropFirst()
+{
+	pop(((byteAt(0) & TAG_MASK) == WIDE) ? 2 : 1);
+	_values--;
+	_tFirst += HISTORY_INTERVAL;
+	while (_len && (byteAt(0) & TAG_MASK) == GAP) {
+		_tFirst += ((byteAt(0) & ~TAG_MASK) + 1) * HISTORY_INTERVAL;
+		pop(1);
+	}
+	if (_values == 0) _len = 0;
+}
+
+
+void History::makeRoom( uint8_t n )
+{
+	while (_values && (HISTORY_SIZE - _len) < n) 
+		dropFirst();
+}
+
+
+/**
+ * @brief Add the count for an interval.
+ *
+ * @param t 	end of interval, in ms
+ * @param count number of pulses in interval
+ */
+void History::add( uint32_t t, uint16_t count )
+{
+	if (_values) {
+		// intervals since the newest entry, more than 1 means there is a gap
+		uint32_t n = (t - _tLast + HISTORY_INTERVAL/2) / HISTORY_INTERVAL;
+		while (n > 1) {
+			uint8_t g = (n-1 > MAX_GAP) ? MAX_GAP : (uint8_t)(n-1);
+			makeRoom(1);
+			if (!_values) break;
+			push(GAP | (g-1));
+			n -= g;
+		}
+	}
+
+	if (count > 0x3FFF) count = 0x3FFF;
+	uint8_t need = (count < 0x80) ? 1 : 2;
+	makeRoom(need);
+	if (!_values) {
+		_len = 0;
+		_tFirst = t;
+	}
+	if (need == 1) {
+		push((uint8_t)count);
+	} else {
+		push(WIDE | (uint8_t)(count >> 8));
+		push((uint8_t)count);
+	}
+	_tLast = t;
+	_values++;
+}
+
+
+/**
+ * @brief Format the oldest counts as text, for sending, e.g. 
+ * "185:40,0,30" means the interval that ended 185 minutes ago had a count 
+ * of 40, the next one 0, the next one 30. Stops at a gap, or when the 
+ * buffer is full.
+ *
+ * @param now 	current time in ms
+ * @param scale multiply counts by this, e.g. liters per pulse
+ * @param buf 	buffer for text
+ * @param size 	size of buffer incl. terminating 0
+ * @return number of counts in the text, remove them with drop() after sending
+ */
+uint8_t History::format( uint32_t now, uint16_t scale, char *buf, uint8_t size ) const
+{
+	char item[12];
+	uint8_t len, n = 0, i = 0;
+
+	if (!_values) return 0;
+	len = snprintf(buf, size, "%lu:", (unsigned long)((now - _tFirst) / 60000uL));
+
+	while (i < _len) {
+		uint8_t b = byteAt(i);
+		if ((b & TAG_MASK) == GAP) break;
+		uint16_t count;
+		if ((b & TAG_MASK) == WIDE) {
+			count = ((uint16_t)(b & ~TAG_MASK) << 8) | byteAt(i+1);
+			i += 2;
+		} else {
+			count = b;
+			i += 1;
+		}
+		uint8_t ilen = snprintf(item, sizeof(item), n ? ",%lu" : "%lu", (unsigned long)count * scale);
+		if (len + ilen >= size) break;
+		for (uint8_t k=0; k<=ilen; k++) buf[len+k] = item[k];
+		len += ilen;
+		n++;
+	}
+	return n;
+}
+
+
+/**
+ * @brief Remove the oldest `n` counts.
+ */
+void History::drop( uint8_t n )
+{
+	while (n-- && _values) 
+		dropFirst();
+}
@@ -0,0 +1,69 @@
+/**
+ * @file 		  History.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+#include <stdint.h>
+
+#define HISTORY_SIZE		200				// bytes, max. 255
+#define HISTORY_INTERVAL	3600000uL		// length of one interval in ms
+
+/**
+ * @brief Ring buffer of pulse counts per interval (hour), for counts that 
+ * could not be sent. 
+ *
+ * Only the time of the oldest entry is stored, each entry is one interval 
+ * after the previous one, unless there is a gap entry in between. 
+ * Entries are encoded as
+ *   0ccccccc			count 0...127
+ *   10cccccc cccccccc	count 128...16383
+ *   11gggggg			gap of g+1 intervals without entry
+ * so one day of typical winter consumption takes 24 bytes.
+ * When the buffer is full, the oldest entries are dropped.
+ */
+class History
+{
+	public:
+		History() : _head(0), _len(0), _values(0) {}
+
+		bool empty() const { return _values == 0; }
+		/// number of counts stored
+		uint8_t count() const { return _values; }
+		void add( uint32_t t, uint16_t count );
+		uint8_t format( uint32_t now, uint16_t scale, char *buf, uint8_t size ) const;
+		void drop( uint8_t n );
+
+	private:
+		uint8_t byteAt( uint8_t i ) const { return _buf[(uint8_t)((_head + i) % HISTORY_SIZE)]; }
+		void push( uint8_t b );
+		void pop( uint8_t n );
+		void dropFirst();
+		void makeRoom( uint8_t n );
+
+		uint8_t _buf[HISTORY_SIZE];
+		uint8_t _head;			// index of oldest byte
+		uint8_t _len;			// number of bytes used
+		uint8_t _values;		// number of counts stored
+		uint32_t _tFirst;		// end of oldest interval, in ms
+		uint32_t _tLast;		// end of newest interval, in ms
+};
+
+#endif // _HISTORY_H
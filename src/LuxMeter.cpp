@@ -24,14 +24,31 @@
  * Connect BPW40 between ADC input and GND, and 10k resistor between same ADC
  * input and a digital output
  * 
+ * Each conversion runs with the CPU in SLEEP_MODE_ADC, which stops the CPU 
+ * and I/O clocks, so there is less noise and less current. Optionally, 
+ * 4^LUX_OVERSAMPLE conversions are added up and decimated, for 
+ * LUX_OVERSAMPLE more bits of resolution, which helps at low light, 
+ * where the ADC input is close to VCC. The sensor is only powered while 
+ * the conversions run.
  */
 
 #include <stdint.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
 #include <util/delay.h>
+#include <Arduino.h>
 #include "stdpins.h"
 
 #include "pins.h"
+#include "LuxMeter.h"
+#include "Twi.h"
+
+#define LUX_SAMPLES		(1 << (2 * LUX_OVERSAMPLE))
+#define LUX_FULL_SCALE	((1024uL << LUX_OVERSAMPLE) - 1)
+
+// only needed to wake up from SLEEP_MODE_ADC
+EMPTY_INTERRUPT(ADC_vect);
 
 
 /**
@@ -49,42 +66,83 @@ void initLux()
 
 
 /**
- * @brief Measure light level
- * For low power use, this will 1. enable ADC, 2. make a measurement, 3. disable ADC
+ * @brief One ADC conversion, with the CPU asleep. Entering SLEEP_MODE_ADC 
+ * starts the conversion, the ADC interrupt ends the sleep. Other interrupts 
+ * (Timer2) may wake the CPU earlier, then we sleep again.
+ * SLEEP_MODE_ADC stops the I/O clock, so a TWI transfer (BME280) or 
+ * serial output still running would stall; both are completed first.
+ * Also used by VccMeter.cpp.
+ */
+uint16_t adcConvertAsleep()
+{
+	twiWait();
+	Serial.flush();
+	set_sleep_mode(SLEEP_MODE_ADC);
+	do {
+		cli();
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	} while (ADCSRA & _BV(ADSC));
+	return ADC;
+}
+
+
+/**
+ * @brief Measure light level with the full resolution.
+ * For low power use, this will 1. enable ADC, 2. make measurements, 3. disable ADC
  * 
- * @return uint16_t  Light level in %, 0=dark 100=bright.
+ * @return ADC reading, 10+LUX_OVERSAMPLE bits, 0=bright, LUX_FULL_SCALE=dark
  */
-uint16_t measureLux()
+static uint16_t measureLuxRaw()
 {
-	uint16_t result;
+	uint32_t sum = 0;
 
-	ASSERT(LUX_POWER);	// power to phototransistor on
 	PRR &= ~_BV(PRADC);
-	ADCSRA |= _BV(ADEN);
+	ADCSRA |= _BV(ADEN) | _BV(ADIE);	// keep prescaler set by basicHwInit()
 
 	uint8_t channel = portBIT(LUX_SIGNAL);
     // Measure Vin against AVCC
     ADMUX 	= (1 << REFS0) 	    // ref 1 = AVCC
             | (channel << MUX0)	// channel 0 = ADC0
             ;
-    // Vref settle
-    //_delay_us(50);
 
-	// Do conversion and ignore
-	ADCSRA |= _BV(ADSC);
-	while (ADCSRA & _BV(ADSC)) {};
-	result = ADC;
+	ASSERT(LUX_POWER);	// power to phototransistor on, only for the conversions
 
-	// Do conversion
-	ADCSRA |= _BV(ADSC);
-	while (ADCSRA & _BV(ADSC)) {};
+	// first conversion after enabling the ADC takes longer, and lets input settle, ignore it
+	adcConvertAsleep();
+	for (uint8_t i=0; i<LUX_SAMPLES; i++)
+		sum += adcConvertAsleep();
 
-	// return Vcc in %
-	result = (ADC * 100L) / 1023L; // in % of VCC
 	NEGATE(LUX_POWER);	// power to phototransistor off
 
-	ADCSRA = 0;
+	ADCSRA &= ~(_BV(ADEN) | _BV(ADIE));
 	PRR |= _BV(PRADC);
 
+	return sum >> LUX_OVERSAMPLE;
+}
+
+
+/**
+ * @brief Measure light level
+ * 
+ * @return uint16_t  Light level in %, 0=dark 100=bright.
+ */
+uint16_t measureLux()
+{
+	uint16_t result = (measureLuxRaw() * 100uL) / LUX_FULL_SCALE;	// in % of VCC
 	return 100-result; // 0%==dark, 100%==bright
 }
+
+
+/**
+ * @brief Measure light level, with the resolution given by LUX_OVERSAMPLE
+ * 
+ * @return uint16_t  Light level in 0.01%, 0=dark 10000=bright.
+ */
+uint16_t measureLuxFine()
+{
+	uint16_t result = (measureLuxRaw() * 10000uL) / LUX_FULL_SCALE;
+	return 10000-result;
+}
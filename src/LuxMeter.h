@@ -3,7 +3,13 @@
 
 #include <stdint.h>
 
+#ifndef LUX_OVERSAMPLE
+ #define LUX_OVERSAMPLE	0	// extra bits of resolution, 0...3, each one takes 4x as many conversions
+#endif
+
 void initLux();
 uint16_t measureLux();
+uint16_t measureLuxFine();
+uint16_t adcConvertAsleep();
 
-#endif // _LUXMETER_H
\ No newline at end of file
+#endif // _LUXMETER_H
@@ -74,7 +74,6 @@
 
 // Arduino and 3rd party libraries
 #include <Arduino.h>
-#include <Wire.h>
 
 #define MY_INDICATION_HANDLER
 #include "mysensors_conf.h"
@@ -82,15 +81,9 @@
 #include <MySensors.h>
 #endif
 
-#ifdef REPORT_CLIMATE
-	#include <Adafruit_Sensor.h>
-	#include <Adafruit_BME280.h>
-#endif
 
 // my libraries from https://github.com/requireiot/
 #include <stdpins.h>
-#include <AvrTimers.h>
-#include <Button.h>
 #include <AvrBattery.h>
 #include <debugstream.h>
 #include <debugstream_arduino.h>
@@ -98,50 +91,130 @@
 // project-specific headers
 #include "Basics.h"
 #include "LuxMeter.h"
+#include "XtalTimer.h"
+#include "Debouncer.h"
+#include "Deadlines.h"
+#include "ReportFrame.h"
+#include "PulseJournal.h"
+#include "History.h"
+#include "ReportPolicy.h"
+#include "NodeDefs.h"
+#include "NodeConfig.h"
+#include "EnergyStats.h"
+#include "Twi.h"
+#include "BME280.h"
+#include "VccMeter.h"
+#include "TxPower.h"
+#include "T1Counter.h"
+#include "SysClock.h"
+#include "BurnerStats.h"
+#include "SensorSet.h"
 #include "pins.h"
 
 //===========================================================================
 #pragma region Constants
 
-#define ISR_RATE 	100		// interrupt rate in Hz
-#define LOOP_RATE	1		// rate of executing loop(), in Hz
-
-#define LITERS_PER_CLICK 10		// depends on gas meter, this is for G4 Metrix 6G4L
-
-//----- timing
+// #define WAKE_ON_PULSE	// wake up via INT1 when contact closes, instead of polling
+// #define PACKED_REPORT	// send all values of one wake period as one binary V_CUSTOM message
+// #define PULSE_JOURNAL	// keep absolute count in EEPROM, so we can continue after a restart
+// #define BACKFILL			// keep hourly counts that could not be sent, send them later
+// #define INSTANT_FLOW		// report flow calculated from time between pulses
+// #define REMOTE_CONFIG	// reporting intervals and liters/pulse can be set by the controller
+// #define ENERGY_STATS		// report CPU time per section and radio on time, uses Timer1
+// #define VCC_AFTER_TX		// measure battery voltage right after the radio has sent, i.e. under load
+// #define ADAPTIVE_PA		// use the lowest transmit power that gets messages through
+// #define RAM_STATS		// report RAM between heap and stack that has never been used
+// #define INSTALL_MODE		// show reed contact state on MIRROR LED, for positioning the sensor
+// #define EXTRA_METERS		// also count pulses of a water meter and an S0 electricity meter, see pins.h
+// #define T1_COUNTER		// with EXTRA_METERS, count S0 pulses at T1 with Timer1 instead of polling
+// #define DYNAMIC_CLOCK	// run the CPU at 1 MHz while asleep, calibrate the RC oscillator against the crystal
+// #define BURNER_STATS		// detect burner cycles from the pulses, report a summary every BURNER_HOURS
+
+// optional sensors, set per environment in platformio.ini
+#ifdef REPORT_LIGHT
+constexpr bool HAS_LIGHT = true;		// phototransistor at ADC, see LuxMeter.h
+#else
+constexpr bool HAS_LIGHT = false;
+#endif
+#ifdef REPORT_CLIMATE
+constexpr bool HAS_CLIMATE = true;		// BME280 at I2C
+#else
+constexpr bool HAS_CLIMATE = false;
+#endif
 
-#define SECONDS		* 1000uL
-#define MINUTES 	* 60uL SECONDS
-#define HOURS 		* 60uL MINUTES
-#define DAYS		* 24uL HOURS
+#ifdef WAKE_ON_PULSE
+ #define IDLE_RATE	1			// Timer2 interrupt rate while waiting for INT1
+ #define ARM_TICKS	8			// poll this many ticks with contact open before waiting for INT1
+ #define CLOSED_TICKS 200		// poll this many ticks with contact closed, then slow down
+#elif defined(EXTRA_METERS) && !defined(T1_COUNTER)
+ #define MIN_RATE	ISR_RATE	// S0 pulses are only 30..100ms long, so always poll fast
+#else
+ #define MIN_RATE	POLL_MIN_RATE	// set to ISR_RATE to always poll fast
+ #define QUIET_TIME	POLL_QUIET_TIME
+#endif
 
-// #define QUICK   // for debugging
+#if defined(EXTRA_METERS) && defined(WAKE_ON_PULSE)
+ #error "EXTRA_METERS needs polling, INT1 only sees the gas meter contact"
+#endif
+#if defined(T1_COUNTER) && !defined(EXTRA_METERS)
+ #error "T1_COUNTER counts the S0 meter of EXTRA_METERS"
+#endif
+#if defined(T1_COUNTER) && defined(ENERGY_STATS)
+ #error "T1_COUNTER and ENERGY_STATS both need Timer1"
+#endif
+#if defined(DYNAMIC_CLOCK) && defined(SOFT_1MHZ)
+ #error "DYNAMIC_CLOCK switches between F_CPU and F_CPU/8, SOFT_1MHZ always runs at F_CPU/8"
+#endif
 
-#ifdef QUICK
-  // time between battery status reports
-  const unsigned long BATTERY_REPORT_INTERVAL = 5 MINUTES;
-  // Sleep time between reports (in milliseconds)
-  const unsigned long MIN_REPORT_INTERVAL = 60 SECONDS;
-  // report climate
-  const unsigned long CLIMATE_REPORT_INTERVAL = 60 SECONDS;
-  // time between light level reports
-  const unsigned long LIGHT_REPORT_INTERVAL   = 2 MINUTES;
+#define PULSE_QUEUE	8			// pulse time stamps buffered between ISR and loop(), power of 2
+
+//----- timing, see also NodeDefs.h
+
+// after requesting configuration, keep radio on this long for the reply from controller
+const unsigned long CONFIG_LISTEN_TIME = 2 SECONDS;
+// while the transport isn't ready, poll it at increasing intervals, for at most this long
+const unsigned long TRANSPORT_WAIT_MAX = MY_TRANSPORT_WAIT_READY_MS;
+const unsigned long TRANSPORT_POLL_MIN = 20;
+const unsigned long TRANSPORT_POLL_MAX = 1 SECONDS;
+// after an unsuccessful wait, don't wait again for this long, doubled every time
+const unsigned long TRANSPORT_BACKOFF_MIN = 1 MINUTES;
+const unsigned long TRANSPORT_BACKOFF_MAX = 1 HOURS;
+// after this many failed messages in one wake period, don't try to send any more
+#define TX_FAIL_BUDGET		2
+// max. number of history messages to send in one wake period
+#define BACKFILL_BATCHES	4
+// no pulse for this long means gas flow has stopped, i.e. min. flow is 120 l/h
+const unsigned long FLOW_TIMEOUT = 5 MINUTES;
+// flow in l/h above which count reports may use ReportPolicy::fastSpacing
+#define HIGH_FLOW	1000
+// with BURNER_STATS, report burner cycles every this many hours
+#define BURNER_HOURS	24
+// BME280 measurement takes >11ms
+const unsigned long CLIMATE_MEASURE_TIME = 20;
+#if LUX_OVERSAMPLE
+ #define LUX_DECIMALS	2		// light level in 0.01%, see measureLuxFine()
+ #define LUX_DEADBAND	50		// 0.5%, the extra resolution is for low light
 #else
-  // time between battery status reports
-  const unsigned long BATTERY_REPORT_INTERVAL = 12 HOURS;
-  // min time between count reports
-  const unsigned long MIN_REPORT_INTERVAL = 5 MINUTES;
-  // report climate
-  const unsigned long CLIMATE_REPORT_INTERVAL = 5 MINUTES;
-  // time between light level reports
-  const unsigned long LIGHT_REPORT_INTERVAL   = 30 MINUTES; 
+ #define LUX_DECIMALS	0		// light level in %
+ #define LUX_DEADBAND	5
 #endif
 
-//----- IDs and Messages
+//----- report-on-change policies, see ReportPolicy.h, and NodeDefs.h for the gas count
+//      (gas flow and volume are sent every hour, R024)
 
-#define SENSOR_ID_TEMPERATURE 		41
-#define SENSOR_ID_HUMIDITY			51
-#define SENSOR_ID_GAS				81   	// gas volume in clicks and m3/h
+/*
+	Sampled values (light, climate, battery) are measured at the intervals 
+	above, but only reported if they have changed by more than the deadband, 
+	or if nothing has been reported for the max. silence. Set the deadband 
+	to 0 to report every change, or maxSilence to the sampling interval to 
+	report every sample.
+*/
+//												deadband	in %	min.spacing				fast	max.silence
+ReportPolicy countPolicy 					= defaultCountPolicy;	// pulses, minSpacing set by applyConfig()
+constexpr ReportPolicy flowNowPolicy 		= {	20,			true,	30 SECONDS,				0,		0 };		// l/h
+constexpr ReportPolicy lightPolicy 			= {	LUX_DEADBAND,	false,	0,						0,		6 HOURS };	// %, 0.01% with LUX_OVERSAMPLE
+constexpr ReportPolicy temperaturePolicy 	= {	2,			false,	0,						0,		1 HOURS };	// 0.1°C
+constexpr ReportPolicy humidityPolicy 		= {	2,			false,	0,						0,		1 HOURS };	// %
 
 //---------------------------------------------------------------------------
 #pragma endregion
@@ -155,333 +228,1098 @@ MyMessage msgAbsCount(SENSOR_ID_GAS,V_VAR1);		// absolute clicks  my/+/stat/120/
 MyMessage msgRelCount(SENSOR_ID_GAS,V_VAR2);		// clicks since last report  my/+/stat/120/81/1/0/25
 #endif
 
-#ifdef REPORT_CLIMATE
-	MyMessage msgTemperature(SENSOR_ID_TEMPERATURE, V_TEMP);
-	MyMessage msgHumidity(SENSOR_ID_HUMIDITY, V_HUM);
-#endif
-
 /*
 	annual consumption is ca 1'000 m3, or 1'000'000 liters
 	uint32_t good enough for 2000 years ...
 */
 
-volatile uint32_t pulseCount = 0;	///< counter for magnet pulses (clicks), updated in ISR
-uint32_t oldPulseCount = 0;			// used to detect changes
+/*
+	The ISR passes pulses to loop() through a single-producer, single-consumer
+	queue: it writes the time stamp, then increments pulseHead. loop() reads 
+	pulseHead, then the time stamps, then increments pulseTail. Each index is 
+	a single byte, written by one side only, so neither side needs to disable 
+	interrupts. The indices run freely modulo 256, so even if loop() falls 
+	behind by more than PULSE_QUEUE pulses, no pulse is lost, only time stamps.
+*/
+volatile uint8_t pulseHead = 0;		///< number of pulses counted by ISR, modulo 256
+uint8_t pulseTail = 0;				///< number of pulses taken over by loop(), modulo 256
+volatile uint32_t pulseTimes[PULSE_QUEUE];	///< time of pulse, in ms
+
+uint32_t pulseCount = 0;			///< counter for magnet pulses (clicks)
 uint32_t absPulseCount = 0;			///< cumulative pulse count
 bool absValid = false;				///< has initial value been received from gateway?
+bool awaitConfirm = false;			///< abs count restored from EEPROM, listening for controller
 uint32_t countPerHour = 0;			///< accumulates clicks for 1 hour
-uint32_t t_last_sent;
 
-uint16_t batteryVoltage = 3300;		// last measured battery voltage in mV
-
-AvrTimer2 timer2;
+bool hadPulse = false;				///< t_lastPulse is valid
+uint32_t t_lastPulse;				///< time of most recent pulse
+uint16_t flowNow = 0;				///< flow from time between last two pulses, in l/h
 
-Button magnet;
+ReportChannel chCount(countPolicy);
 
-bool transportSleeping = false;
+uint16_t batteryVoltage = 3300;		// last measured battery voltage in mV
 
-//---------------------------------------------------------------------------
-#pragma endregion
-//===========================================================================
-#pragma region BME280 handling
+#ifdef EXTRA_METERS
+/*
+	More meters with a pulse output, on other pins of PORTD, polled and 
+	debounced together with the gas meter contact, see myISR(). Each has 
+	its own counts, reporting and handshake for the absolute count, like 
+	the gas meter, but no pulse time stamps, i.e. no instantaneous flow,
+	and no journal in EEPROM. The ISR only counts pulses per meter, modulo 
+	256, loop() takes them over like the gas meter pulses.
+*/
+struct Meter
+{
+	uint8_t mask;					///< bit in PIND, 0 if counted by Timer1
+	uint8_t sensorId;				///< child sensor ID
+	mysensors_sensor_t sensorType;	///< type for presentation
+	mysensors_data_t rateType;		///< hourly usage, in units/h
+	mysensors_data_t totalType;		///< total usage, in units
+	uint16_t unitsPerPulse;			///< scale factor
+	const char *name;				///< description for presentation
+};
 
-#ifdef REPORT_CLIMATE
+#ifdef T1_COUNTER
+ #define POWER_MASK	0				// S0 at T1, see T1Counter.h
+#else
+ #define POWER_MASK	BV(POWER_METER)
+#endif
 
-void operator delete(void * ptr, size_t size) { free(ptr); }
+const Meter meters[] = {
+	// water meter with reed contact, 1 l/pulse
+	{ BV(WATER_METER), SENSOR_ID_WATER, S_WATER, V_FLOW, V_VOLUME, 1, "Water flow&vol" },
+	// S0 output with 1000 pulses/kWh, i.e. 1 Wh/pulse, so Wh/h = W
+	{ POWER_MASK, SENSOR_ID_POWER, S_POWER, V_WATT, V_KWH, 1, "Power&energy [Wh]" },
+};
+#define NUM_METERS	(sizeof(meters)/sizeof(meters[0]))
 
-class MyBME280 : public Adafruit_BME280
+/// counts of one meter, like pulseCount etc. for the gas meter
+struct MeterCount
 {
-	public:
-		using Adafruit_BME280::Adafruit_BME280;
-		void takeForcedMeasurementNoWait();
+	uint8_t tail = 0;				///< pulses taken over from meterHeads[], modulo 256
+	bool absValid = false;			///< has initial value been received from controller?
+	uint32_t count = 0;				///< pulses since last report
+	uint32_t abs = 0;				///< cumulative pulse count
+	uint32_t perHour = 0;			///< pulses in this hour
+	ReportChannel chCount{countPolicy};
+	ReportChannel chRate{flowPolicy};
 };
 
-//---------------------------------------------------------------------------
+volatile uint8_t meterHeads[NUM_METERS];	///< pulses counted by ISR, modulo 256
+MeterCount meterCounts[NUM_METERS];
+#endif // EXTRA_METERS
 
-void MyBME280::takeForcedMeasurementNoWait() 
-{
-  if (_measReg.mode == MODE_FORCED) {
-    // set to forced mode, i.e. "take next measurement"
-    write8(BME280_REGISTER_CONTROL, _measReg.get());
-  }
-}
+Debouncer contacts;				///< all meter contacts, bit set if closed
 
-//---------------------------------------------------------------------------
+bool transportSleeping = false;
 
-/// !=0 if BME sensor found and initialized
-bool validBME = 0;
-/// true if take measurement command sent/to be sent to sensor
-bool requestBME = false;
+/// reporting tasks, in order of priority
+enum {
+	TASK_COUNT,				///< report pulse count, when there were pulses
+	TASK_FLOW,				///< report flow and volume, every hour
+	TASK_CLIMATE_READ,		///< read BME280 measurement
+	TASK_CLIMATE,			///< start BME280 measurement
+	TASK_LIGHT,				///< report light level
+	TASK_BATTERY,			///< start battery voltage measurement
+	TASK_BATTERY_READ,		///< report battery voltage
+	TASK_FLOW_NOW,			///< report instantaneous flow
+	NUM_TASKS
+};
+static_assert(NUM_TASKS <= MAX_DEADLINES, "too many tasks for Deadlines");
 
-MyBME280 bme; 
+Deadlines deadlines;
 
-//---------------------------------------------------------------------------
+#ifdef ENERGY_STATS
+EnergyStats energy;
 
-bool init_Climate()
-{
-	DEBUG_PRINT("Initializing BME ... ");
-	if (bme.begin(0x76)) {
-		DEBUG_PRINT("BME ok\r\n");
-		bme.setSampling(
-			Adafruit_BME280::MODE_FORCED,
-			Adafruit_BME280::SAMPLING_X1,
-			Adafruit_BME280::SAMPLING_NONE,
-			Adafruit_BME280::SAMPLING_X1,
-			Adafruit_BME280::FILTER_OFF
-		);
-        return true;
-	} else {
-		DEBUG_PRINT("BME280 error\r\n");
-        return false;
-	}
-}
+ #define ENERGY_START(v)	uint32_t v = energy.now()
+ #define ENERGY_ADD(s,v)	energy.add(s,v)
+#else
+ #define ENERGY_START(v)
+ #define ENERGY_ADD(s,v)
+#endif
 
-//---------------------------------------------------------------------------
+#ifdef EEPROM_LOCAL_CONFIG_ADDRESS
+ #define JOURNAL_ADDR	EEPROM_LOCAL_CONFIG_ADDRESS		// first EEPROM byte not used by MySensors
+#else
+ #define JOURNAL_ADDR	0
+#endif
+#define CONFIG_ADDR		(JOURNAL_ADDR + JOURNAL_SIZE)	// same with or without PULSE_JOURNAL
 
-bool request_Climate()
-{
-    if (validBME)	
-        bme.takeForcedMeasurementNoWait();
-    return validBME;
-}
+/// settings that may be changed at run time, with REMOTE_CONFIG
+NodeConfig config = { 
+	CONFIG_VERSION,
+	MIN_REPORT_INTERVAL / 1000, CLIMATE_REPORT_INTERVAL / 1000,
+	LIGHT_REPORT_INTERVAL / 1000, BATTERY_REPORT_INTERVAL / 1000,
+	LITERS_PER_CLICK, 0 };
 
-//---------------------------------------------------------------------------
+/// intervals from `config` in ms, converted once by applyConfig()
+struct {
+	uint32_t count, climate, light, battery;
+} intervals;
+
+#ifdef PULSE_JOURNAL
+PulseJournal journal(JOURNAL_ADDR);
 
-bool report_Climate()
+/**
+ * @brief save current absolute count in EEPROM, if it has changed
+ */
+void saveJournal()
 {
-    if (validBME) {
-		float t = bme.readTemperature();
-		if (t != NAN) {
-			send(msgTemperature.set(t,1));
-		}
-		float h = bme.readHumidity();
-		if (h != NAN) {
-			send(msgHumidity.set(h,0));
-		}
-		DEBUG_PRINTF("T=%.1f  H=%.0f\r\n",t,h);
-		return true;
-    } else return false;
+	uint32_t total = absPulseCount + pulseCount;
+	if (total != journal.last())
+		journal.write(total);
 }
-
-#endif // REPORT_CLIMATE
-
-//---------------------------------------------------------------------------
-#pragma endregion
-//===========================================================================
-#pragma region ----- battery stuff
+#endif // PULSE_JOURNAL
 
 #ifdef MY_SENSORS_ON
-#define SENSOR_ID_VCC 		99 		// battery voltage
 
-MyMessage msgVCC( SENSOR_ID_VCC, V_VOLTAGE );
+bool sendOk = false;				///< a message was acknowledged in this wake period
+bool sendFailed = false;			///< a message was not acknowledged in this wake period
+uint8_t txFailures = 0;				///< messages not acknowledged in this wake period
+#ifdef BACKFILL
+bool hourFailed = false;			///< the hourly flow wasn't acknowledged, see backfill()
+#endif
 
+#ifdef ADAPTIVE_PA
+TxPower txPower(RF24_PA_MIN, MY_RF24_PA_LEVEL);
+#endif
 
-static inline
-void presentBattery()
+/**
+ * @brief true if TX_FAIL_BUDGET failures have been used up in this wake period.
+ * Each failed message costs the full number of hardware retransmissions, 
+ * so after that, give up until the next wake period.
+ */
+static bool txBudgetSpent()
 {
-	present(SENSOR_ID_VCC, S_MULTIMETER, "VCC [mV]");
+	if (txFailures < TX_FAIL_BUDGET) return false;
+	sendFailed = true;
+	return true;
 }
 
 
 /**
- * @brief Send MySensors messages with battery level [%] and batery voltage [mV]
- * 
+ * @brief keep track of whether the gateway can be reached, and adapt TX power.
+ * @param ok  result of send(), request() etc.
+ * @return ok
  */
-void reportBatteryVoltage()
+static bool txResult( bool ok )
 {
-	uint16_t batteryVoltage = AvrBattery::measureVCC();
-	send(msgVCC.set(batteryVoltage));
-	uint8_t percent = AvrBattery::calcVCC_Percent(batteryVoltage);
-	DEBUG_PRINTF("Bat: %u mV = %d%%\r\n", batteryVoltage, percent);
-	sendBatteryLevel(percent);
+	if (ok) {
+		sendOk = true;
+	} else {
+		sendFailed = true;
+		txFailures++;
+	}
+	#ifdef ADAPTIVE_PA
+	if (txPower.result(ok)) {
+		RF24_setTxPowerLevel(txPower.level());
+		DEBUG_PRINTF("PA level %u, %u/%u failed\r\n", txPower.level(), txPower.failed(), txPower.sent());
+	}
+	#endif
+	return ok;
 }
-#endif
 
-//-----------------------------------------------------------------------------
-#pragma endregion
-//===========================================================================
-#pragma region Local functions
 
-/*
-    ISR is called every 10ms, debouncer needs 4 samples to recognize edge, 
-    so min 40ms = 25 Hz pulse rate. In reality, meter does > 5s/pulse
-*/
+/**
+ * @brief send message, within the TX_FAIL_BUDGET of this wake period.
+ * All messages to the gateway go through this, or one of the functions below.
+ */
+bool sendChecked( MyMessage &msg )
+{
+	if (txBudgetSpent()) return false;
+	return txResult(send(msg));
+}
+
 
 /**
- * @brief called periodically by Timer2 ISR
+ * @brief ask controller for a value, within the TX_FAIL_BUDGET of this wake period
  */
-void myISR(void) 
+bool requestChecked( uint8_t sensor, uint8_t type )
 {
-	static bool wasDown = false;
-	bool isClosed;
+	if (txBudgetSpent()) return false;
+	return txResult(request(sensor, type));
+}
 
-    SET_LOW(MAGNET_RET);
-    _NOP(); _NOP(); _NOP();
 
-	isClosed = IS_TRUE(MAGNET);
-	SET_PA(MIRROR,isClosed);
+/**
+ * @brief send battery level [%], within the TX_FAIL_BUDGET of this wake period
+ */
+bool sendBatteryLevelChecked( uint8_t percent )
+{
+	if (txBudgetSpent()) return false;
+	return txResult(sendBatteryLevel(percent));
+}
 
-    SET_HIGH(MAGNET_RET);
+#ifdef PACKED_REPORT
+MyMessage msgFrame(SENSOR_ID_GAS, V_CUSTOM);	// binary frame, decode with tools/gasframe
+ReportFrame frame;
+#endif
+
+/**
+ * @brief report one value, either as a message of its own, or as part of 
+ * the frame sent at the end of this wake period
+ * @return false if the message wasn't acknowledged, 
+ *         always true for a frame, see sendFrame()
+ */
+static inline
+bool report( MyMessage &msg, ReportField field, uint32_t value )
+{
+#ifdef PACKED_REPORT
+	(void)msg;
+	frame.set(field, value);
+	return true;
+#else
+	(void)field;
+	return sendChecked(msg.set(value));
+#endif
+}
 
-	magnet.tick(isClosed);
 
-	if (wasDown != magnet.isDown) {
-		wasDown = !wasDown;
-		if (wasDown) 
-			pulseCount++;
+/**
+ * @brief send values collected by report(), as few messages as possible
+ */
+void sendFrame()
+{
+#ifdef PACKED_REPORT
+	uint8_t buf[REPORT_FRAME_MAX];
+	uint8_t len;
+	while ((len = frame.pack(buf, sizeof(buf))) != 0) {
+		bool ok = sendChecked(msgFrame.set(buf, len));
+		frame.sent(ok);
+		#ifdef BACKFILL
+		if (!ok && (buf[1] & _BV(RF_FLOW))) hourFailed = true;
+		#endif
+		transportSleeping = false;
 	}
+#endif
 }
 
+#ifdef BACKFILL
+/*
+	If the hourly flow could not be sent, the pulse count for that hour is 
+	kept in `history`. When the gateway can be reached again, the backlog 
+	is sent as text messages V_VAR3 "<age in minutes>:<liters>,<liters>,...",
+	oldest first, one hour per value, so the controller can fill the gap.
+*/
+
+MyMessage msgHistory(SENSOR_ID_GAS, V_VAR3);	// my/+/stat/120/81/1/0/26
+
+History history;
+bool hourDone = false;				///< taskFlow() has run in this wake period
+uint32_t hourEnd;					///< time when the hour ended
+uint16_t hourCount;					///< pulses in that hour
 
 /**
- * @brief sleep until the next time loop() needs to run.
- * 
- * @param allowTransportDisable  if True, turn off NRF24
- * 
- * The reporting functions in loop() only need to run every 1s, 
- * so if the Timer2 interrupt is more frequent, to enable the 
- * debouncing routine, then return to loop() only once every 1s.
- * 
- * Short version of a wake period (only poll contact) takes ~630ns @ 8 MHz
- * Long version of a wake period (run loop()) takes ~75µs @ 8 MHz (longer if RF transmission). 
+ * @brief called at the end of a wake period, after all messages have been sent
  */
-void snooze(bool allowTransportDisable)
+void backfill( uint32_t t_now )
 {
-	#ifdef MY_SENSORS_ON
-	while (!isTransportReady()) { _process(); }
-	if (allowTransportDisable && !transportSleeping) {
-		transportDisable();
-		transportSleeping = true;
+	if (hourDone) {
+		hourDone = false;
+		if (hourFailed)
+			history.add(hourEnd, hourCount);
 	}
-	#endif
-	Serial.flush();
+	if (!sendOk || sendFailed) return;
 
-	for (uint8_t t=0; t<(ISR_RATE/LOOP_RATE); t++) {
-		#ifdef MY_SENSORS_ON
-		indication(INDICATION_SLEEP);
-		#endif
-		set_sleep_mode(SLEEP_MODE_PWR_SAVE);	
-		cli();
-		sleep_enable();
-#if defined __AVR_ATmega328P__
-		sleep_bod_disable();		
-#endif
-		sei();
-		sleep_cpu();
-		sleep_disable();
-		#ifdef MY_SENSORS_ON
-		indication(INDICATION_WAKEUP);
-		#endif
+	char buf[MAX_PAYLOAD_SIZE+1];
+	for (uint8_t batch=0; batch<BACKFILL_BATCHES && !history.empty(); batch++) {
+		uint8_t n = history.format(t_now, config.litersPerClick, buf, sizeof(buf));
+		if (n == 0 || !sendChecked(msgHistory.set(buf))) break;
+		history.drop(n);
+		transportSleeping = false;
 	}
 }
+#endif // BACKFILL
+
+#endif // MY_SENSORS_ON
 
 //---------------------------------------------------------------------------
 #pragma endregion
 //===========================================================================
-#pragma region light sensor
+#pragma region BME280 handling
 
-#ifdef REPORT_LIGHT
+/**
+ * @brief BME280 at I2C, measured every `config.climateInterval`, temperature 
+ * and humidity reported if they have changed.
+ */
+template<uint8_t ID_T, uint8_t ID_H, const ReportPolicy &policyT, const ReportPolicy &policyH>
+class ClimateSensor
+{
+	public:
+		static void preHwInit();
+		static void present();
+		static void begin();
+		static void apply( uint32_t t_now );
+
+	private:
+		static void task( uint32_t due );
+		static void taskRead( uint32_t due );
+		static bool report( uint32_t t_now );
+
+		static bool valid;				// BME280 found and initialized
+		static BME280 bme;
+		static MyMessage msgTemperature;
+		static MyMessage msgHumidity;
+		static ReportChannel chTemperature;
+		static ReportChannel chHumidity;
+};
 
-#define SENSOR_ID_LIGHT	 			61		// light sensor in %
+#define CLIMATE_TEMPLATE	template<uint8_t ID_T, uint8_t ID_H, const ReportPolicy &policyT, const ReportPolicy &policyH>
+#define CLIMATE_CLASS		ClimateSensor<ID_T,ID_H,policyT,policyH>
 
-MyMessage msgLux( SENSOR_ID_LIGHT, V_LIGHT_LEVEL );
+CLIMATE_TEMPLATE bool CLIMATE_CLASS::valid = false;
+CLIMATE_TEMPLATE BME280 CLIMATE_CLASS::bme;
+CLIMATE_TEMPLATE MyMessage CLIMATE_CLASS::msgTemperature(ID_T, V_TEMP);
+CLIMATE_TEMPLATE MyMessage CLIMATE_CLASS::msgHumidity(ID_H, V_HUM);
+CLIMATE_TEMPLATE ReportChannel CLIMATE_CLASS::chTemperature(policyT);
+CLIMATE_TEMPLATE ReportChannel CLIMATE_CLASS::chHumidity(policyH);
 
+//---------------------------------------------------------------------------
 
-static inline
-void presentLux()
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::preHwInit()
 {
-	// Register sensors to gw
-	//                                    	 1...5...10...15...20...25 max payload
-	//                                    	 |   |    |    |    |    |
-	present(SENSOR_ID_LIGHT, S_LIGHT_LEVEL, "Light [%]");
+    PULLUP_DISABLE(_I2C_SCL);   // ... except no pull-up on SDA,SCL
+    PULLUP_DISABLE(_I2C_SDA);	
 }
 
 
-static inline
-void reportLux()
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::present()
 {
-    uint16_t u = measureLux();
-    send(msgLux.set(u));
+	//                          	 1...5...10...15...20...25 max payload
+	::present(ID_T, S_TEMP, 		"Temperature [°C]");
+	::present(ID_H, S_HUM,			"Humidity [%]");
+}
 
+
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::begin()
+{
+	DEBUG_PRINT("Initializing BME ... ");
+	ENERGY_START(t0);
+	valid = bme.begin(0x76);
+	ENERGY_ADD(ES_I2C, t0);
+	DEBUG_PRINT(valid ? "BME ok\r\n" : "BME280 error\r\n");
 }
 
-#endif // REPORT_LIGHT
+
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::apply( uint32_t t_now )
+{
+	if (valid)
+		deadlines.advance(TASK_CLIMATE, task, t_now + intervals.climate);
+}
 
 //---------------------------------------------------------------------------
-#pragma endregion
-//===========================================================================
-#pragma region MySensor framework functions
 
-#ifdef MY_SENSORS_ON
+/**
+ * @brief trigger BME280 measurement, read it out a bit later
+ */
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::task( uint32_t due )
+{
+	ENERGY_START(t0);
+	bme.startForced();
+	ENERGY_ADD(ES_I2C, t0);
+	deadlines.schedule(TASK_CLIMATE_READ, taskRead, 
+		timer2.get_millis() + CLIMATE_MEASURE_TIME, false);
+	deadlines.schedule(TASK_CLIMATE, task, due + intervals.climate);
+}
 
-void indication( const indication_t ind )
+
+/**
+ * @brief report BME280 measurement that was triggered by task()
+ */
+CLIMATE_TEMPLATE
+void CLIMATE_CLASS::taskRead( uint32_t due )
 {
-	if (ind==INDICATION_SLEEP) {
-		NEGATE(AWAKE);
-	} else if (ind==INDICATION_WAKEUP) {
-		ASSERT(AWAKE);
-	}
+	if (report(due))
+		transportSleeping = false;
 }
 
-//----------------------------------------------------------------------------
 
-void presentation()
+/**
+ * @brief read BME280 measurement, report values that have changed
+ *
+ * @param t_now  time of measurement, in ms
+ * @return true if anything was reported
+ */
+CLIMATE_TEMPLATE
+bool CLIMATE_CLASS::report( uint32_t t_now )
 {
-	static char rev[] = "$Rev: 1321 $";
-	char* p = strchr(rev+6,'$');
-	if (p) *p=0;
+	bool sent = false;
+	int16_t t100;
+	uint16_t h100;
+
+	ENERGY_START(t0);
+	bool ok = bme.read(t100, h100);
+	ENERGY_ADD(ES_I2C, t0);
+	if (!ok) return false;
+
+	int16_t t10 = (t100 + (t100 < 0 ? -5 : 5)) / 10;
+	if (chTemperature.check(t10, t_now)) {
+	#ifdef PACKED_REPORT
+		frame.setSigned(RF_TEMPERATURE, t10);
+	#else
+		// same text as MyMessage::set(float,1), without the float library
+		char buf[8];
+		uint16_t a = (t10 < 0) ? -t10 : t10;
+		snprintf(buf, sizeof(buf), "%s%u.%u", (t10 < 0) ? "-" : "", a / 10, a % 10);
+		sendChecked(msgTemperature.set(buf));
+	#endif
+		chTemperature.sent(t10, t_now);
+		sent = true;
+	}
+	uint8_t h1 = (h100 + 50) / 100;
+	if (chHumidity.check(h1, t_now)) {
+		::report(msgHumidity, RF_HUMIDITY, h1);
+		chHumidity.sent(h1, t_now);
+		sent = true;
+	}
+	DEBUG_PRINTF("T=%d  H=%u (0.01)\r\n", t100, h100);
+	return sent;
+}
 
-	// Send the sketch version information to the gateway and Controller
-	sendSketchInfo("MyGasMeterX", rev+6);
+#undef CLIMATE_TEMPLATE
+#undef CLIMATE_CLASS
 
-	// Register all sensors to gw (they will be created as child devices)
-	//                                    	 1...5...10...15...20...25 max payload
-	//                                    	 |   |    |    |    |    |
-	present(SENSOR_ID_GAS, S_GAS,        	"Gas flow&vol" );
-    presentBattery();
+//---------------------------------------------------------------------------
+#pragma endregion
+//===========================================================================
+#pragma region ----- battery stuff
 
-#ifdef REPORT_LIGHT
-    presentLux();
-#endif // REPORT_LIGHT
+#ifdef MY_SENSORS_ON
+MyMessage msgVCC( SENSOR_ID_VCC, V_VOLTAGE );
+ReportChannel chVCC(vccPolicy);
 
-#ifdef REPORT_CLIMATE
-	//                                    	 1...5...10...15...20...25 max payload
-	present(SENSOR_ID_TEMPERATURE, S_TEMP, 	"Temperature [°C]");
-	present(SENSOR_ID_HUMIDITY, S_HUM,		"Humidity [%]");
-#endif // REPORT_CLIMATE
+
+static inline
+void presentBattery()
+{
+	present(SENSOR_ID_VCC, S_MULTIMETER, "VCC [mV]");
 }
 
-//----------------------------------------------------------------------------
 
-void receive(const MyMessage &message)
+/**
+ * @brief Read battery voltage measurement started by startVCC()
+ *
+ * @return false if the ADC was used for something else in the meantime
+ */
+bool readBatteryVoltage()
 {
-	if (message.isAck()) return;
-	if (message.type==V_VAR1 && message.sensor==SENSOR_ID_GAS) {
-		// received absPulseCount start value from server
-		absPulseCount = message.getLong();
-		absValid = true;
-		DEBUG_PRINTF("Rx abs count %ld\r\n",absPulseCount);
-		send(msgAbsCount.set(absPulseCount + pulseCount));
-	}
+	ENERGY_START(t0);
+	uint16_t mv = collectVCC();
+	ENERGY_ADD(ES_ADC, t0);
+	if (mv == 0) return false;
+	batteryVoltage = mv;
+	return true;
 }
 
-#endif
-
-//---------------------------------------------------------------------------
 
 /**
- * @brief Initialize hardware pins. 
- * Called early in the boot sequence by MySensors framework
+ * @brief Send MySensors messages with battery level [%] and battery voltage [mV],
+ * if voltage has changed
  * 
+ * @param t_now  time of measurement, in ms
+ * @return true if anything was reported
  */
-void preHwInit()
+bool reportBatteryVoltage( uint32_t t_now )
 {
-    basicHwInit();
-#ifdef REPORT_CLIMATE
-    PULLUP_DISABLE(_I2C_SCL);   // ... except no pull-up on SDA,SCL
-    PULLUP_DISABLE(_I2C_SDA);	
+	uint8_t percent = AvrBattery::calcVCC_Percent(batteryVoltage);
+	DEBUG_PRINTF("Bat: %u mV = %d%%\r\n", batteryVoltage, percent);
+	if (!chVCC.check(batteryVoltage, t_now)) return false;
+	report(msgVCC, RF_VCC, batteryVoltage);
+	sendBatteryLevelChecked(percent);
+	chVCC.sent(batteryVoltage, t_now);
+	return true;
+}
 #endif
 
+//-----------------------------------------------------------------------------
+#pragma endregion
+//===========================================================================
+#pragma region Local functions
+
+/*
+    ISR is called every 10ms, debouncer needs 4 samples to recognize edge, 
+    so min 40ms = 25 Hz pulse rate. In reality, meter does > 5s/pulse.
+    Faster or shorter pulses from an S0 output can be counted by Timer1 
+    instead, see T1_COUNTER.
+*/
+
+#ifdef WAKE_ON_PULSE
+
+/*
+	Between pulses, MAGNET_RET is held LOW, so a closing contact pulls PD3 LOW 
+	and triggers INT1 (level, not edge, because only a level interrupt can 
+	wake the CPU from SLEEP_MODE_PWR_SAVE). No current flows while the contact 
+	is open. The INT1 ISR switches Timer2 to ISR_RATE and goes back to polling 
+	with the MAGNET_RET trick, so the debouncer sees the same samples 
+	as without WAKE_ON_PULSE. Once the contact has been open for ARM_TICKS,
+	Timer2 drops back to IDLE_RATE and INT1 is re-armed.
+	If the meter stops with the magnet at the contact, polling slows down 
+	to IDLE_RATE after CLOSED_TICKS, until the contact opens again.
+*/
+
+volatile bool pulseArmed = false;	///< waiting for INT1, not polling
+uint8_t openTicks = 0;				///< ticks with contact open, while polling
+uint8_t closedTicks = 0;			///< ticks with contact closed, while polling
+
+/**
+ * @brief stop polling, wait for INT1 instead
+ */
+static inline
+void armPulseWake()
+{
+	pulseArmed = true;
+	openTicks = 0;
+	SET_LOW(MAGNET_RET);				// now a closing contact pulls MAGNET low
+	EIMSK |= _BV(INT1);
+	timer2.set_rate_isr(xtalRate(IDLE_RATE));
+}
+
+
+/**
+ * @brief contact has closed: stop waiting for INT1, poll contact with ISR_RATE
+ */
+ISR(INT1_vect)
+{
+	#ifdef ENERGY_STATS
+	uint16_t t0 = TCNT1;
+	#endif
+	EIMSK &= ~_BV(INT1);				// level interrupt, so disable while polling
+	SET_HIGH(MAGNET_RET);
+	pulseArmed = false;
+	closedTicks = 0;
+	timer2.restart(xtalRate(ISR_RATE));
+	#ifdef ENERGY_STATS
+	energy.addISR(t0);
+	#endif
+}
+
+#elif MIN_RATE < ISR_RATE
+
+/*
+	Without a pin interrupt, we still don't need to poll at ISR_RATE while
+	the meter is idle. After QUIET_TIME with the contact open, the rate is 
+	halved, and again after each further QUIET_TIME, down to MIN_RATE. 
+	As soon as the contact is seen closed, we go back to ISR_RATE, so the 
+	debouncer sees a closed contact for the same number of ticks as always.
+	MIN_RATE must be fast enough to catch the shortest contact closure: 
+	at the max. flow of a G4 meter, that is still ~1s.
+*/
+
+#define RATE_STEPS	6
+
+constexpr uint16_t stepRate( uint8_t step ) 
+{ 
+	return ((ISR_RATE >> step) > MIN_RATE) ? (ISR_RATE >> step) : MIN_RATE; 
+}
+
+/// Timer2 settings for ISR_RATE, ISR_RATE/2, ISR_RATE/4 ... MIN_RATE
+const XtalRate rateSteps[RATE_STEPS] = { 
+	xtalRate(stepRate(0)), xtalRate(stepRate(1)), xtalRate(stepRate(2)),
+	xtalRate(stepRate(3)), xtalRate(stepRate(4)), xtalRate(MIN_RATE) 
+};
+
+uint8_t rateStep = 0;				///< index into rateSteps[]
+uint32_t t_active = 0;				///< last time the contact was closed
+
+/**
+ * @brief adjust Timer2 rate to meter activity, called from Timer2 ISR
+ */
+static inline
+void adaptRate( uint8_t closed )
+{
+	uint32_t t_now = timer2.get_millis_isr();
+
+	if (closed || contacts.state) {
+		t_active = t_now;
+		if (rateStep != 0) {
+			rateStep = 0;
+			timer2.set_rate_isr(rateSteps[0]);
+		}
+	} else if (rateStep < RATE_STEPS-1 
+			&& (uint32_t)(t_now - t_active) >= (rateStep+1) * (uint32_t)QUIET_TIME) {
+		timer2.set_rate_isr(rateSteps[++rateStep]);
+	}
+}
+
+#endif // WAKE_ON_PULSE
+
+
+/// contacts on PORTD, all returned to MAGNET_RET
+#if defined(EXTRA_METERS)
+ #define CONTACTS	(BV(MAGNET) | BV(WATER_METER) | POWER_MASK)
+#else
+ #define CONTACTS	BV(MAGNET)
+#endif
+
+/**
+ * @brief called periodically by Timer2 ISR, inlined into it, see below.
+ * All contacts are sampled with one read of PIND and debounced together,
+ * so each extra meter only costs ISR time when one of its pulses begins.
+ */
+static inline
+void myISR(void) 
+{
+#ifdef WAKE_ON_PULSE
+	if (pulseArmed) return;
+#endif
+
+    SET_LOW(MAGNET_RET);
+    _NOP(); _NOP(); _NOP();
+
+	uint8_t closed = (uint8_t)~PIND & CONTACTS;		// LOW when closed
+#ifdef INSTALL_MODE
+	SET_PA(MIRROR, closed & BV(MAGNET));
+#endif
+
+    SET_HIGH(MAGNET_RET);
+
+	uint8_t pressed = contacts.tick(closed) & contacts.state;
+	if (pressed & BV(MAGNET)) {
+		pulseTimes[pulseHead & (PULSE_QUEUE-1)] = timer2.get_millis_isr();
+		pulseHead++;
+	}
+#ifdef EXTRA_METERS
+	if (pressed & ~BV(MAGNET)) {
+		for (uint8_t i=0; i<NUM_METERS; i++)
+			if (pressed & meters[i].mask) meterHeads[i]++;
+	}
+#endif
+
+#ifdef WAKE_ON_PULSE
+	if (closed) {
+		openTicks = 0;
+		if (closedTicks < CLOSED_TICKS) 
+			closedTicks++;
+		else 
+			timer2.set_rate_isr(xtalRate(IDLE_RATE));
+	} else {
+		closedTicks = 0;
+		timer2.set_rate_isr(xtalRate(ISR_RATE));
+		if (!contacts.state && ++openTicks >= ARM_TICKS)
+			armPulseWake();
+	}
+#elif MIN_RATE < ISR_RATE
+	adaptRate(closed);
+#endif
+}
+
+
+/*
+	The callback is bound at compile time, so the compiler inlines the 
+	millisecond count, myISR() and the debouncer into one ISR without any 
+	calls, and only saves the registers it actually uses.
+*/
+ISR(TIMER2_COMPA_vect)
+{
+#ifdef ENERGY_STATS
+	uint16_t t0 = TCNT1;
+	timer2.tick<myISR>();
+	energy.addISR(t0);
+#else
+	timer2.tick<myISR>();
+#endif
+}
+
+
+#ifdef ENERGY_STATS
+ISR(TIMER1_OVF_vect)
+{
+	energy.overflow();
+}
+#endif
+
+
+#ifdef T1_COUNTER
+/// any edge at T1 only wakes the CPU, so Timer1 sees it, see T1Counter.h
+EMPTY_INTERRUPT(PCINT2_vect);
+
+/// first S0 pulse after a report
+ISR(TIMER1_COMPA_vect)
+{
+	t1Counter.compareMatch();
+}
+#endif
+
+
+#ifdef MY_SENSORS_ON
+uint32_t t_transportRetry = 0;						///< don't wait for the transport before this time
+uint32_t transportBackoff = TRANSPORT_BACKOFF_MIN;	///< pause after the next unsuccessful wait
+
+/**
+ * @brief If the transport isn't ready, e.g. because it is looking for its 
+ * parent after the gateway was unreachable, run its state machine for up to
+ * TRANSPORT_WAIT_MAX, with the CPU in idle sleep between polls. Idle sleep 
+ * keeps Timer0 running, which MySensors uses for its timeouts, and Timer2 
+ * keeps counting pulses. If the transport is still not ready, don't wait 
+ * again before the backoff time, which doubles with every failure.
+ */
+void waitTransport()
+{
+	if (isTransportReady()) {
+		transportBackoff = TRANSPORT_BACKOFF_MIN;
+		return;
+	}
+	uint32_t t_start = timer2.get_millis();
+	if ((int32_t)(t_start - t_transportRetry) < 0) return;
+
+	uint32_t pause = TRANSPORT_POLL_MIN;
+	for (;;) {
+		_process();
+		if (isTransportReady()) {
+			transportBackoff = TRANSPORT_BACKOFF_MIN;
+			return;
+		}
+		uint32_t t_poll = timer2.get_millis();
+		if ((unsigned long)(t_poll - t_start) >= TRANSPORT_WAIT_MAX) break;
+		while ((int32_t)(timer2.get_millis() - (t_poll + pause)) < 0) {
+			set_sleep_mode(SLEEP_MODE_IDLE);
+			cli();
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		if (pause < TRANSPORT_POLL_MAX) pause *= 2;
+	}
+	DEBUG_PRINT("Transport not ready\r\n");
+	t_transportRetry = timer2.get_millis() + transportBackoff;
+	transportBackoff = (transportBackoff < TRANSPORT_BACKOFF_MAX/2) ? 2*transportBackoff : TRANSPORT_BACKOFF_MAX;
+}
+#endif // MY_SENSORS_ON
+
+/**
+ * @brief has the ISR counted pulses that loop() hasn't taken over yet?
+ */
+static inline
+bool pulsesPending()
+{
+	if (pulseHead != pulseTail) return true;
+#ifdef EXTRA_METERS
+	for (uint8_t i=0; i<NUM_METERS; i++)
+		if (meterHeads[i] != meterCounts[i].tail) return true;
+#endif
+#ifdef T1_COUNTER
+	if (t1Counter.woken()) return true;
+#endif
+	return false;
+}
+
+
+/**
+ * @brief sleep until the next deadline, or until a pulse has been counted.
+ * 
+ * @param allowTransportDisable  if True, turn off NRF24
+ * @param t_wake  time to wake up, in ms as returned by timer2.get_millis()
+ * 
+ * The Timer2 interrupt must continue at ISR_RATE to debounce the switch,
+ * but we only return to loop() when a task is due or a new pulse needs 
+ * to be reported. The Timer2 rate may change while we sleep, so compare
+ * milliseconds, not ticks.
+ * 
+ * Short version of a wake period (only poll contact) takes ~630ns @ 8 MHz
+ * Long version of a wake period (run loop()) takes ~75µs @ 8 MHz (longer if RF transmission). 
+ */
+void snooze(bool allowTransportDisable, uint32_t t_wake)
+{
+	#ifdef MY_SENSORS_ON
+	waitTransport();
+	if (allowTransportDisable && !transportSleeping) {
+		transportDisable();
+		transportSleeping = true;
+		#ifdef ENERGY_STATS
+		energy.radioOff(timer2.get_millis());
+		#endif
+	}
+	#endif
+	ENERGY_START(t0);
+	Serial.flush();
+	ENERGY_ADD(ES_SERIAL, t0);
+
+	#ifdef DYNAMIC_CLOCK
+	// only the ISR runs until we return, and it doesn't depend on the CPU clock
+	clockSlow();
+	#endif
+	while (!pulsesPending() && (int32_t)(timer2.get_millis() - t_wake) < 0) {
+		#ifdef MY_SENSORS_ON
+		indication(INDICATION_SLEEP);
+		#endif
+		timer2.sync();
+		// the TWI needs the I/O clock until a transfer has completed
+		set_sleep_mode(twiBusy() ? SLEEP_MODE_IDLE : SLEEP_MODE_PWR_SAVE);
+		cli();
+		sleep_enable();
+#if defined __AVR_ATmega328P__
+		sleep_bod_disable();		
+#endif
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		#ifdef MY_SENSORS_ON
+		indication(INDICATION_WAKEUP);
+		#endif
+	}
+	#ifdef DYNAMIC_CLOCK
+	clockFast();
+	#endif
+}
+
+
+#ifdef DYNAMIC_CLOCK
+/**
+ * @brief Calibrate the RC oscillator against the watch crystal, so the UART 
+ * baud rate stays right as temperature and battery voltage change.
+ * With T1_COUNTER, Timer1 can't count CPU cycles, so the factory calibration has to do.
+ */
+static void calibrateClock()
+{
+	#ifndef T1_COUNTER
+	Serial.flush();
+	int16_t err = calibrateOsc();
+	DEBUG_PRINTF("OSCCAL %u, error %d/1000\r\n", OSCCAL, err);
+	#endif
+}
+#endif
+
+//---------------------------------------------------------------------------
+#pragma endregion
+//===========================================================================
+#pragma region light sensor
+
+/**
+ * @brief Light level at the phototransistor in %, measured every 
+ * `config.lightInterval`, reported if it has changed.
+ */
+template<uint8_t ID, const ReportPolicy &policy>
+class LightSensor
+{
+	public:
+		static void preHwInit() { initLux(); }
+		static void present();
+		static void begin() {}
+		static void apply( uint32_t t_now );
+
+	private:
+		static void task( uint32_t due );
+
+		static MyMessage msg;
+		static ReportChannel channel;
+};
+
+template<uint8_t ID, const ReportPolicy &policy>
+MyMessage LightSensor<ID,policy>::msg( ID, V_LIGHT_LEVEL );
+
+template<uint8_t ID, const ReportPolicy &policy>
+ReportChannel LightSensor<ID,policy>::channel( policy );
+
+
+template<uint8_t ID, const ReportPolicy &policy>
+void LightSensor<ID,policy>::present()
+{
+	// Register sensors to gw
+	//                  	 1...5...10...15...20...25 max payload
+	//                  	 |   |    |    |    |    |
+	::present(ID, S_LIGHT_LEVEL, "Light [%]");
+}
+
+
+template<uint8_t ID, const ReportPolicy &policy>
+void LightSensor<ID,policy>::apply( uint32_t t_now )
+{
+	deadlines.advance(TASK_LIGHT, task, t_now + intervals.light);
+}
+
+
+/**
+ * @brief every 30min or so, measure light, and report it if it has changed
+ */
+template<uint8_t ID, const ReportPolicy &policy>
+void LightSensor<ID,policy>::task( uint32_t due )
+{
+	ENERGY_START(t0);
+	#if LUX_OVERSAMPLE
+	uint16_t u = measureLuxFine();
+	#else
+    uint16_t u = measureLux();
+	#endif
+	ENERGY_ADD(ES_ADC, t0);
+	if (channel.check(u, due)) {
+	#ifdef PACKED_REPORT
+		frame.set(RF_LIGHT, (LUX_DECIMALS == 2) ? u : u * 100u);	// always in 0.01%
+	#elif LUX_DECIMALS
+		// same text as MyMessage::set(float,2), without the float library
+		char buf[8];
+		snprintf(buf, sizeof(buf), "%u.%02u", u / 100, u % 100);
+		sendChecked(msg.set(buf));
+	#else
+		sendChecked(msg.set(u));
+	#endif
+		channel.sent(u, due);
+		transportSleeping = false;
+	}
+	deadlines.schedule(TASK_LIGHT, task, due + intervals.light);
+}
+
+//---------------------------------------------------------------------------
+
+/// the optional sensors of this variant
+typedef SensorSet<
+	Select<HAS_LIGHT, LightSensor<SENSOR_ID_LIGHT, lightPolicy>, NoSensor>::type,
+	Select<HAS_CLIMATE, ClimateSensor<SENSOR_ID_TEMPERATURE, SENSOR_ID_HUMIDITY, 
+									  temperaturePolicy, humidityPolicy>, NoSensor>::type
+	> Sensors;
+
+//---------------------------------------------------------------------------
+#pragma endregion
+//===========================================================================
+#pragma region MySensor framework functions
+
+#ifdef MY_SENSORS_ON
+
+void indication( const indication_t ind )
+{
+	if (ind==INDICATION_SLEEP) {
+		NEGATE(AWAKE);
+	} else if (ind==INDICATION_WAKEUP) {
+		ASSERT(AWAKE);
+	}
+	#ifdef ENERGY_STATS
+	else if (ind==INDICATION_TX) {
+		energy.tx();
+	} else if (ind==INDICATION_ERR_TX) {
+		energy.txFailed();
+	}
+	#endif
+}
+
+//----------------------------------------------------------------------------
+
+void presentation()
+{
+	static char rev[] = "$Rev: 1321 $";
+	char* p = strchr(rev+6,'$');
+	if (p) *p=0;
+
+	// Send the sketch version information to the gateway and Controller
+	sendSketchInfo("MyGasMeterX", rev+6);
+
+	// Register all sensors to gw (they will be created as child devices)
+	//                                    	 1...5...10...15...20...25 max payload
+	//                                    	 |   |    |    |    |    |
+	present(SENSOR_ID_GAS, S_GAS,        	"Gas flow&vol" );
+#ifdef INSTANT_FLOW
+	present(SENSOR_ID_FLOW, S_GAS,        	"Gas flow now [l/h]" );
+#endif
+#ifdef ENERGY_STATS
+	present(SENSOR_ID_ENERGY, S_INFO,      	"Energy stats" );
+#endif
+#ifdef RAM_STATS
+	present(SENSOR_ID_RAM, S_INFO,      	"RAM stats" );
+#endif
+#ifdef BURNER_STATS
+	present(SENSOR_ID_BURNER, S_INFO,      	"Burner cycles" );
+#endif
+#ifdef EXTRA_METERS
+	for (uint8_t i=0; i<NUM_METERS; i++)
+		present(meters[i].sensorId, meters[i].sensorType, meters[i].name);
+#endif
+    presentBattery();
+	Sensors::present();
+}
+
+//----------------------------------------------------------------------------
+
+#ifdef REMOTE_CONFIG
+/*
+	The controller can change reporting intervals and liters/pulse with a
+	V_VAR4 message to the gas sensor, e.g. "count=600,light=3600", see 
+	NodeConfig.h. The node replies "ok", or the rest of the text starting 
+	at the first invalid setting, in which case nothing is changed.
+	The radio is usually off, so the node asks for its configuration with 
+	every battery check, and listens for CONFIG_LISTEN_TIME.
+*/
+
+MyMessage msgConfig(SENSOR_ID_GAS, V_VAR4);		// my/+/stat/120/81/1/0/27 or my/cmnd/120/81/1/0/27
+
+NodeConfig newConfig;				///< received, to be applied by loop()
+bool configPending = false;			///< newConfig is valid
+bool awaitConfig = false;			///< configuration requested, listening for controller
+uint32_t t_configEnd;				///< stop listening at this time
+
+/**
+ * @brief ask controller for configuration, and listen for the reply
+ */
+void requestConfig( uint32_t t_now )
+{
+	requestChecked(SENSOR_ID_GAS, V_VAR4);
+	awaitConfig = true;
+	t_configEnd = t_now + CONFIG_LISTEN_TIME;
+}
+#endif // REMOTE_CONFIG
+
+//----------------------------------------------------------------------------
+
+void receive(const MyMessage &message)
+{
+	if (message.isAck()) return;
+	#ifdef REMOTE_CONFIG
+	if (message.type==V_VAR4 && message.sensor==SENSOR_ID_GAS) {
+		char buf[MAX_PAYLOAD_SIZE+1];
+		message.getString(buf);
+		newConfig = configPending ? newConfig : config;
+		const char *bad = newConfig.parse(buf);
+		if (!bad) configPending = true;
+		awaitConfig = false;
+		DEBUG_PRINTF("Rx config '%s' %s\r\n", buf, bad ? "rejected" : "ok");
+		sendChecked(msgConfig.set(bad ? bad : "ok"));
+		return;
+	}
+	#endif
+	if (message.type==V_VAR1 && message.sensor==SENSOR_ID_GAS) {
+		// received absPulseCount start value from server
+		absPulseCount = message.getLong();
+		absValid = true;
+		awaitConfirm = false;
+		DEBUG_PRINTF("Rx abs count %ld\r\n",absPulseCount);
+		sendChecked(msgAbsCount.set(absPulseCount + pulseCount));
+		#ifdef PULSE_JOURNAL
+		saveJournal();
+		#endif
+		return;
+	}
+	#ifdef EXTRA_METERS
+	if (message.type==V_VAR1) {
+		for (uint8_t i=0; i<NUM_METERS; i++) {
+			if (message.sensor != meters[i].sensorId) continue;
+			MeterCount &c = meterCounts[i];
+			c.abs = message.getLong();
+			c.absValid = true;
+			DEBUG_PRINTF("Rx abs count %ld for %u\r\n", c.abs, message.sensor);
+			MyMessage msg(message.sensor, V_VAR1);
+			sendChecked(msg.set(c.abs + c.count));
+		}
+	}
+	#endif
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Initialize hardware pins. 
+ * Called early in the boot sequence by MySensors framework
+ * 
+ */
+void preHwInit()
+{
+    basicHwInit();
+
     // configure pins used by this application
 
     AS_OUTPUT(AWAKE);
@@ -494,10 +1332,471 @@ void preHwInit()
 	SET_HIGH(MAGNET_RET);
     
 	AS_INPUT_PU(MAGNET);	
+#ifdef EXTRA_METERS
+	AS_INPUT_PU(WATER_METER);
+	AS_INPUT_PU(POWER_METER);
+#endif
+#ifdef T1_COUNTER
+	AS_INPUT_PU(PULSE_T1);
+#endif
+#ifdef WAKE_ON_PULSE
+	EICRA &= ~(_BV(ISC11) | _BV(ISC10));	// INT1 on LOW level
+#endif
+
+	Sensors::preHwInit();
+}
+
+//---------------------------------------------------------------------------
+#pragma endregion
+//===========================================================================
+#pragma region Reporting tasks
+
+/*
+	Each task is run by the deadline queue when due, and schedules its own 
+	next run, relative to the time it was due, so intervals don't drift 
+	when tasks are run late or early. Whether a value is actually sent is 
+	decided by its ReportChannel, see the report policies above.
+*/
+
+/**
+ * @brief is gas flowing fast, so counts may be reported more often?
+ */
+static inline
+bool flowHigh( uint32_t t_now )
+{
+	return flowNow >= HIGH_FLOW && (uint32_t)(t_now - t_lastPulse) < FLOW_TIMEOUT;
+}
+
+
+void taskCount( uint32_t due );
+
+#ifdef EXTRA_METERS
+MyMessage msgMeter;			///< for all extra meters, sensor and type set before sending
+
+static inline
+void sendMeter( uint8_t sensorId, uint8_t type, uint32_t value )
+{
+	sendChecked(msgMeter.setSensor(sensorId).setType(type).set(value));
+}
+
+
+/**
+ * @brief have all extra meters received their absolute count?
+ */
+static inline
+bool metersValid()
+{
+	for (uint8_t i=0; i<NUM_METERS; i++)
+		if (!meterCounts[i].absValid) return false;
+	return true;
+}
+
+
+/**
+ * @brief take over pulses of the extra meters counted by the ISR, and 
+ * report them as soon as the count policy allows
+ */
+void takeMeterPulses( uint32_t t_now )
+{
+	for (uint8_t i=0; i<NUM_METERS; i++) {
+		MeterCount &c = meterCounts[i];
+		uint16_t n;
+		#ifdef T1_COUNTER
+		if (meters[i].mask == 0) {
+			n = t1Counter.take();
+		} else
+		#endif
+		{
+			uint8_t head = meterHeads[i];
+			n = (uint8_t)(head - c.tail);
+			c.tail = head;
+		}
+		if (n == 0) continue;
+		c.count += n;
+		c.perHour += n;
+		deadlines.advance(TASK_COUNT, taskCount, c.chCount.earliest(t_now), false);
+	}
+}
+
+
+/**
+ * @brief report counts of the extra meters, like countGas() does for 
+ * the gas meter, called by taskCount()
+ *
+ * @return time when taskCount() must run again for the extra meters
+ */
+uint32_t countMeters( uint32_t due )
+{
+	uint32_t t_next = due + 1 DAYS;
+	for (uint8_t i=0; i<NUM_METERS; i++) {
+		const Meter &m = meters[i];
+		MeterCount &c = meterCounts[i];
+		if (c.chCount.check(c.count, due)) {
+			uint32_t count = c.count;
+			sendMeter(m.sensorId, V_VAR2, count);
+			if (c.absValid) {
+				c.count = 0;
+				c.abs += count;
+				sendMeter(m.sensorId, V_VAR1, c.abs);
+			} else {
+				requestChecked(m.sensorId, V_VAR1);
+			}
+			c.chCount.sent(count, due);
+			transportSleeping = false;
+			DEBUG_PRINTF("%u: rel %ld, abs %ld\r\n", m.sensorId, count, c.abs);
+		}
+		#ifdef T1_COUNTER
+		// the next pulse wakes loop() once, to schedule this task again
+		if (m.mask == 0) t1Counter.watch();
+		#endif
+		// as for the gas meter, a relative count of 0 is reported when the pulses stop
+		uint32_t t = c.chCount.changed(c.count) ? c.chCount.earliest(due) : c.chCount.heartbeat();
+		if ((int32_t)(t - t_next) < 0) t_next = t;
+	}
+	return t_next;
+}
+
+
+/**
+ * @brief report hourly usage and total of the extra meters, called by taskFlow()
+ */
+void flowMeters( uint32_t due )
+{
+	for (uint8_t i=0; i<NUM_METERS; i++) {
+		const Meter &m = meters[i];
+		MeterCount &c = meterCounts[i];
+		uint32_t units = c.perHour * m.unitsPerPulse;
+		if (c.chRate.check(units, due)) {
+			sendMeter(m.sensorId, m.rateType, units);
+			c.chRate.sent(units, due);
+			if (c.absValid) 
+				sendMeter(m.sensorId, m.totalType, c.abs * m.unitsPerPulse);
+			transportSleeping = false;
+		}
+		c.perHour = 0;
+	}
+}
+#endif // EXTRA_METERS
+
+
+/**
+ * @brief report gas pulse count, scheduled by loop() after a pulse was counted,
+ * and by itself until the count has been reported as 0, or for a heartbeat
+ */
+static inline
+void countGas( uint32_t due )
+{
+	uint32_t count;
+
+	if (!chCount.check(pulseCount, due, flowHigh(due))) {
+		// run early for an extra meter, or the controller has changed the min. spacing
+		if (chCount.changed(pulseCount))
+			deadlines.schedule(TASK_COUNT, taskCount, chCount.earliest(due, flowHigh(due)), false);
+		else if (chCount.policy().maxSilence)
+			deadlines.schedule(TASK_COUNT, taskCount, chCount.heartbeat(), false);
+		return;
+	}
+
+	if (absValid) {
+		// once we have received a valid start value for abs count, we accumulate
+		count = pulseCount;
+		pulseCount = 0;
+		absPulseCount += count;
+		#ifdef MY_SENSORS_ON
+		report(msgRelCount, RF_REL_COUNT, count);
+		report(msgAbsCount, RF_ABS_COUNT, absPulseCount);
+		#else
+		DEBUG_PRINTF("[SERIAL]Count %ld Abs Count %ld\r\n", count, absPulseCount);
+		#endif
+	} else {
+		// only send relative counts
+		count = pulseCount;
+		#ifdef MY_SENSORS_ON
+		report(msgRelCount, RF_REL_COUNT, count);
+		DEBUG_PRINT("Requesting AbsCount\r\n");
+		requestChecked(SENSOR_ID_GAS, V_VAR1);
+		#else
+		DEBUG_PRINTF("[SERIAL]Count %ld\r\n", count);
+		#endif
+	}
+	transportSleeping = false;
+	chCount.sent(count, due);
+	countPerHour += count;
+	DEBUG_PRINTF("rel %ld, abs %ld\r\n", count, absPulseCount);
+
+	// check again after min. spacing, so a relative count of 0 is reported
+	// when the pulses stop
+	if (count != 0)
+		deadlines.schedule(TASK_COUNT, taskCount, chCount.earliest(due, flowHigh(due)), false);
+	else if (chCount.policy().maxSilence)
+		deadlines.schedule(TASK_COUNT, taskCount, chCount.heartbeat(), false);
+}
+
+
+/**
+ * @brief report pulse counts of all meters
+ */
+void taskCount( uint32_t due )
+{
+	countGas(due);
+	#ifdef EXTRA_METERS
+	deadlines.advance(TASK_COUNT, taskCount, countMeters(due), false);
+	#endif
+}
+
+
+#ifdef BURNER_STATS
+/*
+	Whether the boiler short-cycles can be seen from the pulse times alone,
+	but only with reports at every pulse. Instead, BurnerStats detects the
+	cycles on the node, and a summary is sent every BURNER_HOURS.
+*/
+
+MyMessage msgBurner(SENSOR_ID_BURNER, V_TEXT);	// my/+/stat/120/83/1/0/47
+
+BurnerStats burner;
+uint8_t burnerHours = 0;			///< hours since last burner report
+
+/**
+ * @brief every BURNER_HOURS, report burner cycles, called by taskFlow()
+ */
+void reportBurner()
+{
+	if (++burnerHours < BURNER_HOURS) return;
+	burnerHours = 0;
+
+	char buf[MAX_PAYLOAD_SIZE+1];
+	burner.format(timer2.get_millis(), config.litersPerClick, buf, sizeof(buf));
+	DEBUG_PRINTF("Burner %s\r\n", buf);
+	sendChecked(msgBurner.set(buf));
+	burner.clear();
+	transportSleeping = false;
+}
+#endif
+
+
+/**
+ * @brief once per hour, calculate and report liters/h, and the volume (R024),
+ * even if unchanged
+ */
+void taskFlow( uint32_t due )
+{
+	uint32_t liters;
+	liters = countPerHour * config.litersPerClick;
+	#if defined(BACKFILL)
+	hourFailed = !report(msgGasFlow, RF_FLOW, liters);
+	#elif defined(MY_SENSORS_ON)
+	report(msgGasFlow, RF_FLOW, liters);
+	#else
+	DEBUG_PRINTF("[SERIAL]Liters %ld\r\n", liters);
+	#endif
+	if (absValid) {
+		liters = absPulseCount * config.litersPerClick;
+		#ifdef MY_SENSORS_ON
+		report(msgGasVolume, RF_VOLUME, liters);
+		#else
+		DEBUG_PRINTF("[SERIAL]Liters %ld\r\n", liters);
+		#endif
+	}
+	transportSleeping = false;
+	#ifdef BACKFILL
+	hourDone = true;
+	hourEnd = due;
+	hourCount = (countPerHour > 0xFFFF) ? 0xFFFF : countPerHour;
+	#endif
+	countPerHour = 0;
+	#ifdef EXTRA_METERS
+	flowMeters(due);
+	#endif
+	#ifdef BURNER_STATS
+	reportBurner();
+	#endif
+	#ifdef PULSE_JOURNAL
+	if (absValid) saveJournal();
+	#endif
+	deadlines.schedule(TASK_FLOW, taskFlow, due + 1 HOURS);
+}
+
+
+
+#ifdef RAM_STATS
+MyMessage msgRam(SENSOR_ID_RAM, V_TEXT);		// my/+/stat/120/97/1/0/47
+
+/**
+ * @brief report RAM between heap and stack that has never been used since 
+ * boot, and what is free now, in bytes
+ */
+void reportRam()
+{
+	char buf[MAX_PAYLOAD_SIZE+1];
+	snprintf(buf, sizeof(buf), "S %u,%u", ramNeverUsed(), ramFree());
+	DEBUG_PRINTF("RAM %s\r\n", buf);
+	sendChecked(msgRam.set(buf));
+}
+#endif
+
+
+#ifdef ENERGY_STATS
+MyMessage msgEnergy(SENSOR_ID_ENERGY, V_TEXT);	// my/+/stat/120/98/1/0/47
 
-#ifdef REPORT_LIGHT	
-    initLux();
-#endif // REPORT_LIGHT
+/**
+ * @brief report CPU time per section and radio statistics since last report
+ */
+void reportEnergy()
+{
+	char cpu[MAX_PAYLOAD_SIZE+1], radio[MAX_PAYLOAD_SIZE+1];
+	uint32_t t_now = timer2.get_millis();
+	energy.format(t_now, cpu, radio, sizeof(cpu));
+	DEBUG_PRINTF("Energy %s %s\r\n", cpu, radio);
+	sendChecked(msgEnergy.set(cpu));
+	sendChecked(msgEnergy.set(radio));
+	energy.clear(t_now);
+}
+#endif
+
+
+#ifdef MY_SENSORS_ON
+#ifdef VCC_AFTER_TX
+bool vccAfterTx = false;			///< battery voltage to be read at the end of this wake period
+#endif
+
+/**
+ * @brief report battery voltage measurement that was started by taskBattery()
+ */
+void taskBatteryRead( uint32_t due )
+{
+	if (!readBatteryVoltage()) {
+		// light level was measured in between, start again
+		startVCC();
+		deadlines.schedule(TASK_BATTERY_READ, taskBatteryRead, 
+			timer2.get_millis() + VCC_SETTLE_TIME, false);
+		return;
+	}
+	if (reportBatteryVoltage(due))
+		transportSleeping = false;
+}
+#endif
+
+
+/**
+ * @brief twice a day or so, check battery status
+ */
+void taskBattery( uint32_t due )
+{
+	#ifdef MY_SENSORS_ON
+	startVCC();
+	#ifdef VCC_AFTER_TX
+	vccAfterTx = true;
+	#else
+	deadlines.schedule(TASK_BATTERY_READ, taskBatteryRead, 
+		timer2.get_millis() + VCC_SETTLE_TIME, false);
+	#endif
+	#else
+	DEBUG_PRINT("[SERIAL]reportBatteryVoltage\r\n");
+	#endif
+	#ifdef REMOTE_CONFIG
+	requestConfig(timer2.get_millis());
+	transportSleeping = false;
+	#endif
+	#ifdef ENERGY_STATS
+	reportEnergy();
+	transportSleeping = false;
+	#endif
+	#ifdef RAM_STATS
+	reportRam();
+	transportSleeping = false;
+	#endif
+	#ifdef DYNAMIC_CLOCK
+	calibrateClock();
+	#endif
+	deadlines.schedule(TASK_BATTERY, taskBattery, due + intervals.battery);
+}
+
+
+
+#ifdef INSTANT_FLOW
+/*
+	Flow is calculated from the time between the last two pulses, so it is
+	known two pulses after the burner starts, not only at the end of the hour.
+	It is reported as flowNowPolicy allows, and as 0 once there has been 
+	no pulse for FLOW_TIMEOUT.
+*/
+
+MyMessage msgFlowNow(SENSOR_ID_FLOW, V_FLOW);	// in l/h		my/+/stat/120/82/1/0/34
+ReportChannel chFlowNow(flowNowPolicy);
+
+/**
+ * @brief report instantaneous flow if it has changed, or 0 if gas has stopped
+ */
+void taskFlowNow( uint32_t due )
+{
+	if ((unsigned long)(due - t_lastPulse) >= FLOW_TIMEOUT) 
+		flowNow = 0;
+	if (chFlowNow.check(flowNow, due)) {
+		#ifdef MY_SENSORS_ON
+		sendChecked(msgFlowNow.set(flowNow));
+		#else
+		DEBUG_PRINTF("[SERIAL]Flow %u\r\n", flowNow);
+		#endif
+		chFlowNow.sent(flowNow, due);
+		transportSleeping = false;
+	}
+	if (flowNow)	// check when gas will have stopped
+		deadlines.schedule(TASK_FLOW_NOW, taskFlowNow, t_lastPulse + FLOW_TIMEOUT);
+}
+#endif // INSTANT_FLOW
+
+
+/**
+ * @brief update instantaneous flow, called for every pulse
+ *
+ * @param t 	time of pulse, in ms
+ */
+void newPulse( uint32_t t )
+{
+	#ifdef BURNER_STATS
+	burner.pulse(t);
+	#endif
+	uint32_t dt = t - t_lastPulse;
+	bool valid = hadPulse && (dt > 0) && (dt < FLOW_TIMEOUT);
+	hadPulse = true;
+	t_lastPulse = t;
+	if (!valid) return;		// first pulse after a pause
+
+	uint32_t flow = (config.litersPerClick * 3600000uL) / dt;
+	flowNow = (flow > 0xFFFF) ? 0xFFFF : flow;
+
+	#ifdef INSTANT_FLOW
+	uint32_t t_due = t + FLOW_TIMEOUT;
+	if (chFlowNow.changed(flowNow))
+		t_due = chFlowNow.earliest(timer2.get_millis());
+	deadlines.schedule(TASK_FLOW_NOW, taskFlowNow, t_due);
+	#endif
+}
+
+
+/**
+ * @brief take over pulses counted by the ISR
+ *
+ * @return true if there were new pulses
+ */
+bool takePulses()
+{
+	uint8_t head = pulseHead;
+	uint8_t n = head - pulseTail;
+
+	if (n == 0) return false;
+	if (n > PULSE_QUEUE) {
+		// time stamps of the oldest pulses have been overwritten, just count them
+		pulseCount += n - PULSE_QUEUE;
+		pulseTail = head - PULSE_QUEUE;
+	}
+	while (pulseTail != head) {
+		newPulse(pulseTimes[pulseTail & (PULSE_QUEUE-1)]);
+		pulseTail++;
+		pulseCount++;
+	}
+	return true;
 }
 
 //---------------------------------------------------------------------------
@@ -505,6 +1804,26 @@ void preHwInit()
 //===========================================================================
 #pragma region Arduino framework functions
 
+/**
+ * @brief make settings in `config` take effect
+ *
+ * @param t_now  current time in ms, tasks scheduled later than one new 
+ *				 interval from now are moved earlier
+ */
+void applyConfig( uint32_t t_now )
+{
+	intervals.count = config.countInterval SECONDS;
+	intervals.climate = config.climateInterval SECONDS;
+	intervals.light = config.lightInterval SECONDS;
+	intervals.battery = config.batteryInterval SECONDS;
+
+	countPolicy.minSpacing = intervals.count;
+	deadlines.advance(TASK_BATTERY, taskBattery, t_now + intervals.battery);
+	Sensors::apply(t_now);
+}
+
+//----------------------------------------------------------------------------
+
 void setup()
 {
 	#ifndef MY_SENSORS_ON
@@ -512,28 +1831,60 @@ void setup()
 	preHwInit();
 	#endif
 	basicSetup();
+	#ifdef ENERGY_STATS
+	energy.begin();
+	#endif
+
+	#ifdef PULSE_JOURNAL
+	// continue counting right away, controller may still correct the value
+	if (journal.restore(absPulseCount)) {
+		absValid = true;
+		awaitConfirm = true;
+		DEBUG_PRINTF("EEPROM abs count %ld\r\n", absPulseCount);
+	}
+	#endif
+	#ifdef REMOTE_CONFIG
+	if (config.load(CONFIG_ADDR))
+		DEBUG_PRINTF("EEPROM config, %u l/pulse\r\n", config.litersPerClick);
+	#endif
 
     #ifdef MY_SENSORS_ON
 	// when entering setup(), a lot of RF packets have just been transmitted, so
 	// let's wait a bit to let the battery voltage recover, then report
+	startVCC();
 	sleep(100);
-	reportBatteryVoltage();
+	readBatteryVoltage();
+	reportBatteryVoltage(0);
 
 	// Fetch last known pulse count value from gw
-	request(SENSOR_ID_GAS, V_VAR1);
-	send(msgAbsCount.set(0));	// this triggers sending the "real" value
+	requestChecked(SENSOR_ID_GAS, V_VAR1);
+	// without a count from EEPROM, 0 triggers sending the "real" value
+	sendChecked(msgAbsCount.set(absValid ? absPulseCount : 0));
+	#ifdef EXTRA_METERS
+	for (uint8_t i=0; i<NUM_METERS; i++)
+		requestChecked(meters[i].sensorId, V_VAR1);
+	#endif
+	#ifdef REMOTE_CONFIG
+	requestConfig(0);
+	#endif
 	#endif
 
-	timer2.begin(ISR_RATE, 0, myISR, 32768ul, true);		// async mode, 32768 Hz clock
-    timer2.handle_millis();
+	timer2.begin(xtalRate(ISR_RATE));	// async mode, 32768 Hz clock
     TIMSK0 = 0;							// disable all T0 interrupts (Arduino millis() )
 	timer2.start();		// start debouncing the switch
+	#ifdef T1_COUNTER
+	t1Counter.begin();
+	#endif
+	#ifdef DYNAMIC_CLOCK
+	calibrateClock();
+	#endif
 
-	t_last_sent = timer2.get_millis();
-
-#ifdef REPORT_CLIMATE
-	validBME = init_Climate();
-#endif // REPORT_CLIMATE
+	uint32_t t_now = timer2.get_millis();
+	deadlines.schedule(TASK_FLOW, taskFlow, t_now + 1 HOURS);
+	if (countPolicy.maxSilence)
+		deadlines.schedule(TASK_COUNT, taskCount, t_now + countPolicy.maxSilence, false);
+	Sensors::begin();
+	applyConfig(t_now);		// schedules battery and sensor tasks
 
 	//           1...5...10........20........30........40        50        60  63
 	//           |   |    |    |    |    |    |    |    |    |    |    |    |   |
@@ -547,110 +1898,81 @@ void setup()
 
 void loop()
 {
-	static uint32_t t_battery_report=0uL;
-	static uint32_t t_hourly = 0;
-	uint32_t count;
-
-	snooze(absValid);
-	
 	uint32_t t_now = timer2.get_millis();
+	ENERGY_START(t_loop);
+	#ifdef ENERGY_STATS
+	bool radioWasOff = transportSleeping;
+	#endif
 
-	bool sendNow = ((unsigned long)(t_now - t_last_sent) >= MIN_REPORT_INTERVAL );
-
-	if (sendNow && (pulseCount != oldPulseCount)) {
-		if (absValid) {
-			// once we have received a valid start value for abs count, we accumulate
-			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-				count = pulseCount;
-				pulseCount = 0;
-			}
-			absPulseCount += count;
-			#ifdef MY_SENSORS_ON
-			send(msgRelCount.set(count));
-			send(msgAbsCount.set(absPulseCount));
-			#else
-			DEBUG_PRINTF("[SERIAL]Count %ld Abs Count %ld\r\n", count, absPulseCount);
-			#endif
-		} else {
-			// only send relative counts
-			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-				count = pulseCount;
-			}
-			#ifdef MY_SENSORS_ON
-			send(msgRelCount.set(count));
-            DEBUG_PRINT("Requesting AbsCount\r\n");
-			request(SENSOR_ID_GAS, V_VAR1);
-			#else
-			DEBUG_PRINTF("[SERIAL]Count %ld\r\n", count);
-			#endif
-		}
-		transportSleeping = false;
-		oldPulseCount = count;
-		countPerHour += count;
-		DEBUG_PRINTF("rel %ld, abs %ld\r\n", count, absPulseCount);
-		t_last_sent = t_now;
-	}
-
-	// once per hour, calculate and report liters/h
-	if ( (unsigned long)(t_now - t_hourly) > 1 HOURS ) {
-		t_hourly = t_now;
-		uint32_t liters;
-		liters = countPerHour * LITERS_PER_CLICK;
-		#ifdef MY_SENSORS_ON
-		send(msgGasFlow.set(liters));
-		#else
-		DEBUG_PRINTF("[SERIAL]Liters %ld\r\n", liters);
-		#endif
-		if (absValid) {
-			liters = absPulseCount * LITERS_PER_CLICK;
-			#ifdef MY_SENSORS_ON
-			send(msgGasVolume.set(liters));
-			#else
-			DEBUG_PRINTF("[SERIAL]Liters %ld\r\n", liters);
-			#endif
-		}
-		transportSleeping = false;
-		countPerHour = 0;
+	#ifdef REMOTE_CONFIG
+	if (configPending) {
+		// received since the last wake period
+		configPending = false;
+		config = newConfig;
+		config.save(CONFIG_ADDR);
+		applyConfig(t_now);
 	}
+	#endif
 
-#ifdef REPORT_LIGHT
-	static uint32_t t_light_report=0uL;
-
-	// every 30min or so, report light
-	if ((unsigned long)(t_now - t_light_report) >= LIGHT_REPORT_INTERVAL) {
-		t_light_report = t_now;
-        reportLux();
-		transportSleeping = false;
+	if (takePulses()) {
+		// report new pulses as soon as the count policy allows
+		deadlines.advance(TASK_COUNT, taskCount, chCount.earliest(t_now, flowHigh(t_now)), false);
 	}
-#endif 
+	#ifdef EXTRA_METERS
+	takeMeterPulses(t_now);
+	#endif
 
-	// once a day or so, report battery status
-  	if ((unsigned long)(t_now - t_battery_report) >= BATTERY_REPORT_INTERVAL) {
-		t_battery_report = t_now;
-		#ifdef MY_SENSORS_ON
-		reportBatteryVoltage();
-		#else
-		DEBUG_PRINT("[SERIAL]reportBatteryVoltage\r\n");
-		#endif
-		transportSleeping = false;
+	#ifdef MY_SENSORS_ON
+	sendOk = sendFailed = false;
+	txFailures = 0;
+	#endif
+	deadlines.run(t_now, TASK_SLACK);
+	#ifdef MY_SENSORS_ON
+	sendFrame();
+	#ifdef BACKFILL
+	backfill(t_now);
+	#endif
+	#ifdef VCC_AFTER_TX
+	if (vccAfterTx) {
+		vccAfterTx = false;
+		if (!transportSleeping) {
+			// the radio is on and has just been sending, this is the voltage under load
+			taskBatteryRead(t_now);
+			sendFrame();
+		} else {
+			deadlines.schedule(TASK_BATTERY_READ, taskBatteryRead, t_now + VCC_SETTLE_TIME, false);
+		}
 	}
+	#endif
+	#endif
 
-#ifdef REPORT_CLIMATE
-	static uint32_t t_climate_report=0uL;
-	//static uint32_t t_climate_read;
-
-	// if BME sensor measurement was triggered before last sleep period, report it now
-	if (validBME && requestBME && ((unsigned long)(t_now - t_climate_report) > 10uL ))	{
-        report_Climate();
-		requestBME = false;
-		transportSleeping = false;
-	}
+	if (awaitConfirm && (unsigned long)t_now >= CONFIRM_TIME)
+		awaitConfirm = false;
+	#ifdef REMOTE_CONFIG
+	if (awaitConfig && (int32_t)(t_now - t_configEnd) >= 0)
+		awaitConfig = false;
+	bool listen = !absValid || awaitConfirm || awaitConfig;
+	#else
+	bool listen = !absValid || awaitConfirm;
+	#endif
+	#ifdef EXTRA_METERS
+	listen = listen || !metersValid();
+	#endif
 
-  	if ((unsigned long)(t_now - t_climate_report) >= CLIMATE_REPORT_INTERVAL) {
-		t_climate_report = t_now;
-		requestBME = request_Climate();		// trigger BME280 measurement before next snooze
+	uint32_t t_wake = t_now + 1 DAYS;
+	deadlines.next(t_wake);
+	#ifdef MY_SENSORS_ON
+	if (listen && (int32_t)(t_wake - t_now) > (int32_t)RX_POLL_INTERVAL) {
+		// radio stays on, poll for the base count from the controller
+		t_wake = t_now + RX_POLL_INTERVAL;
 	}
-#endif // REPORT_CLIMATE
+	#endif
+	#ifdef ENERGY_STATS
+	if (radioWasOff && !transportSleeping)
+		energy.radioOn(t_now);
+	#endif
+	ENERGY_ADD(ES_LOOP, t_loop);
+	snooze(!listen, t_wake);
 }
 
 //---------------------------------------------------------------------------
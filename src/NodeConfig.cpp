@@ -0,0 +1,150 @@
+/**
+ * @file 		  NodeConfig.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Run-time configuration, set by the controller, saved in EEPROM.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "NodeConfig.h"
+
+/// one setting: its name, where it is in NodeConfig, and its valid range
+struct ConfigKey
+{
+	const char *name;
+	uint8_t offset;
+	uint8_t size;				// 2 or 4 bytes
+	uint32_t min, max;
+};
+
+static const ConfigKey keys[] = {
+	{ "count",		offsetof(NodeConfig,countInterval),		4,	10,		86400uL },
+	{ "climate",	offsetof(NodeConfig,climateInterval),	4,	10,		86400uL },
+	{ "light",		offsetof(NodeConfig,lightInterval),		4,	60,		86400uL },
+	{ "battery",	offsetof(NodeConfig,batteryInterval),	4,	600,	7 * 86400uL },
+	{ "lpc",		offsetof(NodeConfig,litersPerClick),	2,	1,		1000 },
+};
+
+#define N_KEYS	(sizeof(keys) / sizeof(keys[0]))
+
+
+static uint8_t configCRC( const NodeConfig &c )
+{
+	const uint8_t *p = (const uint8_t*)&c;
+	uint8_t crc = 0;
+	for (uint8_t i=0; i<offsetof(NodeConfig,crc); i++)
+		crc = _crc8_ccitt_update(crc, p[i]);
+	return crc;
+}
+
+
+static uint32_t getValue( const NodeConfig &c, const ConfigKey &k )
+{
+	const uint8_t *p = (const uint8_t*)&c + k.offset;
+	if (k.size == 2) { uint16_t v; memcpy(&v, p, 2); return v; }
+	uint32_t v; memcpy(&v, p, 4); return v;
+}
+
+
+static void setValue( NodeConfig &c, const ConfigKey &k, uint32_t value )
+{
+	uint8_t *p = (uint8_t*)&c + k.offset;
+	if (k.size == 2) { uint16_t v = value; memcpy(p, &v, 2); }
+	else memcpy(p, &value, 4);
+}
+
+
+/**
+ * @brief Are all settings within their valid range?
+ */
+bool NodeConfig::valid() const
+{
+	for (uint8_t i=0; i<N_KEYS; i++) {
+		uint32_t v = getValue(*this, keys[i]);
+		if (v < keys[i].min || v > keys[i].max) return false;
+	}
+	return true;
+}
+
+
+/**
+ * @brief Read configuration from EEPROM. 
+ *
+ * @param addr 	EEPROM address
+ * @return true if a valid configuration was found, otherwise unchanged
+ */
+bool NodeConfig::load( uint16_t addr )
+{
+	NodeConfig c;
+	eeprom_read_block(&c, (const void*)(uintptr_t)addr, sizeof(c));
+	if (c.version != CONFIG_VERSION || c.crc != configCRC(c) || !c.valid()) 
+		return false;
+	*this = c;
+	return true;
+}
+
+
+/**
+ * @brief Write configuration to EEPROM, only bytes that have changed.
+ */
+void NodeConfig::save( uint16_t addr )
+{
+	version = CONFIG_VERSION;
+	crc = configCRC(*this);
+	eeprom_update_block(this, (void*)(uintptr_t)addr, sizeof(*this));
+}
+
+
+/**
+ * @brief Change settings from a text like "count=600,light=3600".
+ * Either all settings are changed, or none.
+ *
+ * @param text 	list of key=value, separated by ',' or ' '
+ * @return NULL if ok, else pointer to the first invalid setting in `text`
+ */
+const char* NodeConfig::parse( const char *text )
+{
+	NodeConfig c = *this;
+	const char *p = text;
+
+	while (*p) {
+		if (*p == ',' || *p == ' ') { p++; continue; }
+		const char *eq = strchr(p, '=');
+		if (!eq) return p;
+		uint8_t i;
+		for (i=0; i<N_KEYS; i++)
+			if (strlen(keys[i].name) == (size_t)(eq-p) && !strncmp(p, keys[i].name, eq-p)) break;
+		if (i == N_KEYS) return p;
+		char *end;
+		uint32_t v = strtoul(eq+1, &end, 10);
+		if (end == eq+1 || (*end && *end != ',' && *end != ' ')) return p;
+		if (v < keys[i].min || v > keys[i].max) return p;
+		setValue(c, keys[i], v);
+		p = end;
+	}
+	*this = c;
+	return NULL;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file 		  NodeConfig.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _NODECONFIG_H
+#define _NODECONFIG_H
+
+#include <stdint.h>
+
+#define CONFIG_VERSION	1		// increment when the layout of NodeConfig changes
+
+/**
+ * @brief Reporting intervals and conversion factor that can be changed 
+ * at run time, by a text message "key=value,key=value..." from the controller.
+ *
+ * Keys are
+ *	count	min. time between count reports, in s
+ *	climate	time between climate measurements, in s
+ *	light	time between light measurements, in s
+ *	battery	time between battery measurements, in s
+ *	lpc		liters per pulse of the gas meter
+ *
+ * Saved in EEPROM with a version byte and a CRC, so an erased or outdated 
+ * EEPROM is recognized, and the compiled-in defaults are used instead.
+ */
+struct NodeConfig
+{
+	uint8_t version;			///< CONFIG_VERSION
+	uint32_t countInterval;		///< min. time between count reports, in s
+	uint32_t climateInterval;	///< time between climate measurements, in s
+	uint32_t lightInterval;		///< time between light measurements, in s
+	uint32_t batteryInterval;	///< time between battery measurements, in s
+	uint16_t litersPerClick;	///< liters per pulse of the gas meter
+	uint8_t crc;				///< CRC-8 over all of the above
+
+	bool load( uint16_t addr );
+	void save( uint16_t addr );
+	bool valid() const;
+	const char* parse( const char *text );
+} __attribute__((packed));
+
+#define CONFIG_SIZE		sizeof(NodeConfig)
+
+#endif // _NODECONFIG_H
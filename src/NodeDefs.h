@@ -0,0 +1,100 @@
+/**
+ * @file 		  NodeDefs.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief What the controller sees of a gas meter node: child sensor IDs,
+ * liters per pulse, when counts and flow are reported, and how long the
+ * node listens for its base count. Used by MyGasMeterX.cpp, and by the
+ * host tools that must behave like it (tools/gasload, tools/gasframe).
+ */
+
+#ifndef _NODEDEFS_H
+#define _NODEDEFS_H
+
+#include <stdint.h>
+
+#include "ReportPolicy.h"
+
+//----- timing
+
+#define SECONDS		* 1000uL
+#define MINUTES 	* 60uL SECONDS
+#define HOURS 		* 60uL MINUTES
+#define DAYS		* 24uL HOURS
+
+// #define QUICK   // for debugging
+
+#ifdef QUICK
+  // time between battery status reports
+  const unsigned long BATTERY_REPORT_INTERVAL = 5 MINUTES;
+  // Sleep time between reports (in milliseconds)
+  const unsigned long MIN_REPORT_INTERVAL = 60 SECONDS;
+  // report climate
+  const unsigned long CLIMATE_REPORT_INTERVAL = 60 SECONDS;
+  // time between light level reports
+  const unsigned long LIGHT_REPORT_INTERVAL   = 2 MINUTES;
+#else
+  // time between battery status reports (defaults, see NodeConfig.h)
+  const unsigned long BATTERY_REPORT_INTERVAL = 12 HOURS;
+  // min time between count reports
+  const unsigned long MIN_REPORT_INTERVAL = 5 MINUTES;
+  // report climate
+  const unsigned long CLIMATE_REPORT_INTERVAL = 5 MINUTES;
+  // time between light level reports
+  const unsigned long LIGHT_REPORT_INTERVAL   = 30 MINUTES;
+#endif
+
+// tasks due within this time after the first due task run in the same wake period
+const unsigned long TASK_SLACK = 10 SECONDS;
+// wake up this often to receive messages while the radio is kept on
+const unsigned long RX_POLL_INTERVAL = 1 SECONDS;
+// after restoring count from EEPROM, keep radio on this long for a correction from controller
+const unsigned long CONFIRM_TIME = 10 SECONDS;
+
+//----- gas meter contact
+
+#define ISR_RATE 	100		// interrupt rate in Hz, the debouncer sees the contact at this rate
+#define POLL_MIN_RATE	4	// slowest polling rate in Hz, while the meter is idle
+#define POLL_QUIET_TIME	2000	// ms without activity before each step down to the next lower rate
+
+#define LITERS_PER_CLICK 10		// default, depends on gas meter, this is for G4 Metrix 6G4L
+
+//----- report-on-change policies of the gas meter and battery, see ReportPolicy.h
+
+//												deadband	in %	min.spacing				fast	max.silence
+constexpr ReportPolicy defaultCountPolicy 	= {	0,			false,	MIN_REPORT_INTERVAL,	0,		1 DAYS };	// pulses
+constexpr ReportPolicy flowPolicy 			= {	0,			false,	0,						0,		6 HOURS };	// l/h, hourly, of EXTRA_METERS
+constexpr ReportPolicy vccPolicy 			= {	20,			false,	0,						0,		1 DAYS };	// mV
+
+//----- IDs
+
+#define SENSOR_ID_TEMPERATURE 		41
+#define SENSOR_ID_HUMIDITY			51
+#define SENSOR_ID_LIGHT	 			61		// light sensor in %
+#define SENSOR_ID_GAS				81   	// gas volume in clicks and m3/h
+#define SENSOR_ID_FLOW				82		// instantaneous gas flow in l/h
+#define SENSOR_ID_BURNER			83		// burner cycle statistics, see BurnerStats.h
+#define SENSOR_ID_WATER				85		// water volume in pulses and l/h, with EXTRA_METERS
+#define SENSOR_ID_POWER				86		// electric energy in pulses and W, with EXTRA_METERS
+#define SENSOR_ID_RAM				97		// unused RAM, see basicPaintRam()
+#define SENSOR_ID_ENERGY			98		// energy accounting, see EnergyStats.h
+#define SENSOR_ID_VCC 				99 		// battery voltage
+
+#endif // _NODEDEFS_H
@@ -0,0 +1,91 @@
+/**
+ * @file 		  PulseJournal.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Wear-levelled journal of the absolute pulse count in EEPROM.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "PulseJournal.h"
+
+
+static uint8_t slotCRC( const JournalSlot &s )
+{
+	const uint8_t *p = (const uint8_t*)&s;
+	uint8_t crc = 0;
+	for (uint8_t i=0; i<offsetof(JournalSlot,crc); i++)
+		crc = _crc8_ccitt_update(crc, p[i]);
+	return crc;
+}
+
+
+static inline bool isErased( const JournalSlot &s )
+{
+	return s.seq == 0xFFFF && s.count == 0xFFFFFFFFuL;
+}
+
+
+/**
+ * @brief Find the newest valid slot. Call once at startup.
+ * Reads JOURNAL_SIZE bytes of EEPROM, takes well below 1ms.
+ *
+ * @param count 	set to the saved pulse count, if any
+ * @return true if a valid slot was found
+ */
+bool PulseJournal::restore( uint32_t &count )
+{
+	bool found = false;
+	JournalSlot s;
+
+	for (uint8_t i=0; i<JOURNAL_SLOTS; i++) {
+		eeprom_read_block(&s, (const void*)(_addr + i*sizeof(JournalSlot)), sizeof(s));
+		if (isErased(s) || s.crc != slotCRC(s)) continue;
+		// sequence numbers wrap around, compare their difference
+		if (!found || (int16_t)(s.seq - _seq) > 0) {
+			found = true;
+			_slot = i;
+			_seq = s.seq;
+			_count = s.count;
+		}
+	}
+	if (found) count = _count;
+	return found;
+}
+
+
+/**
+ * @brief Save pulse count in the slot after the newest one. 
+ * Takes ~3.4ms per byte written, i.e. up to ~25ms.
+ */
+void PulseJournal::write( uint32_t count )
+{
+	JournalSlot s;
+
+	if (++_slot >= JOURNAL_SLOTS) _slot = 0;
+	s.seq = ++_seq;
+	s.count = count;
+	s.crc = slotCRC(s);
+	eeprom_update_block(&s, (void*)(_addr + _slot*sizeof(JournalSlot)), sizeof(s));
+	_count = count;
+}
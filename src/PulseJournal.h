@@ -0,0 +1,65 @@
+/**
+ * @file 		  PulseJournal.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _PULSEJOURNAL_H
+#define _PULSEJOURNAL_H
+
+#include <stdint.h>
+
+#define JOURNAL_SLOTS	16		// number of slots in the ring, spreads EEPROM wear
+
+/// one journal entry in EEPROM
+struct JournalSlot
+{
+	uint16_t seq;			///< incremented with every write
+	uint32_t count;			///< absolute pulse count
+	uint8_t crc;			///< CRC-8 over seq and count
+} __attribute__((packed));
+
+#define JOURNAL_SIZE	(JOURNAL_SLOTS * sizeof(JournalSlot))
+
+/**
+ * @brief Ring of slots in EEPROM holding the absolute pulse count, 
+ * so the node can continue counting after a restart without waiting 
+ * for the controller.
+ *
+ * Each write goes to the next slot, so with 16 slots and one write per 
+ * hour, each EEPROM cell is written ~550 times a year. A write that is 
+ * interrupted by a power failure leaves a slot with a bad CRC, which is 
+ * ignored, so the previous value survives.
+ */
+class PulseJournal
+{
+	public:
+		PulseJournal( uint16_t addr ) : _addr(addr), _slot(JOURNAL_SLOTS-1), _seq(0), _count(0) {}
+
+		bool restore( uint32_t &count );
+		void write( uint32_t count );
+		/// last value written or restored
+		uint32_t last() const { return _count; }
+
+	private:
+		uint16_t _addr;			// EEPROM address of first slot
+		uint8_t _slot;			// newest slot
+		uint16_t _seq;			// sequence number of newest slot
+		uint32_t _count;		// value of newest slot
+};
+
+#endif // _PULSEJOURNAL_H
@@ -0,0 +1,122 @@
+/**
+ * @file 		  ReportFrame.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Encoder for the compact report frame, see ReportFrame.h
+ */
+
+#include <stdint.h>
+
+#include "ReportFrame.h"
+
+
+/**
+ * @brief Set a field value, replacing any earlier value of the same field.
+ */
+void ReportFrame::set( ReportField field, uint32_t value )
+{
+	_value[field] = value;
+	_present |= (1u << field);
+}
+
+
+/**
+ * @brief Encode a value as varint.
+ *
+ * @param v 	value
+ * @param buf 	receives up to 5 bytes
+ * @return number of bytes
+ */
+static uint8_t varint( uint32_t v, uint8_t *buf )
+{
+	uint8_t n = 0;
+	do {
+		buf[n] = v & 0x7F;
+		v >>= 7;
+		if (v) buf[n] |= 0x80;
+		n++;
+	} while (v);
+	return n;
+}
+
+
+/**
+ * @brief Pack as many of the collected values as fit into one frame, 
+ * and remove them from the collection. If not all values fit, call again
+ * for the next frame. Call sent() after each frame.
+ *
+ * @param buf 	buffer for the frame
+ * @param size 	size of buffer, at most REPORT_FRAME_MAX
+ * @return uint8_t length of frame, 0 if there were no values
+ */
+uint8_t ReportFrame::pack( uint8_t *buf, uint8_t size )
+{
+	_packedAbs = false;
+	if (_present == 0 || size < 4) return 0;
+
+	// absolute count as difference to the reference, if that is shorter
+	uint8_t tmp[5];
+	const uint8_t absBit = 1u << RF_ABS_COUNT;
+	uint32_t absValue = _value[RF_ABS_COUNT];
+	uint32_t diff = zigzagEncode((int32_t)(absValue - _ref));
+	bool delta = (_present & absBit) && _refValid && _deltas < REPORT_FRAME_KEY-1 
+		&& varint(diff, tmp) + 1 < varint(absValue, tmp);
+
+	uint8_t len = 2;
+	uint8_t mask = 0;
+	if (delta) buf[len++] = (uint8_t)_ref;
+
+	for (uint8_t field=0; field<RF_NUM_FIELDS; field++) {
+		uint8_t bit = 1u << field;
+		if (!(_present & bit)) continue;
+
+		uint32_t v = (delta && field == RF_ABS_COUNT) ? diff : _value[field];
+		uint8_t n = varint(v, tmp);
+		if (len + n > size) continue;	// try remaining fields, leave this one for next frame
+		for (uint8_t i=0; i<n; i++) buf[len++] = tmp[i];
+		mask |= bit;
+	}
+
+	buf[0] = delta ? REPORT_FRAME_DELTA : REPORT_FRAME_VERSION;
+	buf[1] = mask;
+	_present &= ~mask;
+	if (mask & absBit) {
+		_packedAbs = true;
+		_packedDelta = delta;
+		_packedValue = absValue;
+	}
+	return len;
+}
+
+
+/**
+ * @brief Result of sending the frame returned by the last pack(). 
+ * The absolute count of an acknowledged frame becomes the new reference.
+ *
+ * @param ok 	true if the gateway has acknowledged the frame
+ */
+void ReportFrame::sent( bool ok )
+{
+	if (!ok || !_packedAbs) return;
+	_deltas = _packedDelta ? _deltas+1 : 0;
+	_ref = _packedValue;
+	_refValid = true;
+	_packedAbs = false;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file 		  ReportFrame.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Compact binary frame carrying all values reported in one wake period,
+ * sent as a single V_CUSTOM message instead of one message per value.
+ *
+ * Layout:
+ *   byte 0		frame type, REPORT_FRAME_VERSION or REPORT_FRAME_DELTA
+ *   byte 1		bit mask of fields present, bit n = field n
+ *   (byte 2)	REPORT_FRAME_DELTA only: low byte of the reference count
+ *   byte 2...	field values in order of field number, each as a varint
+ *				(7 bits per byte, LSB first, bit 7 set if more bytes follow).
+ *				Signed values are zigzag-encoded first.
+ *
+ * The absolute count is the largest value, a 3-byte varint, and changes 
+ * by a few pulses between reports. So once the gateway has acknowledged 
+ * a frame with the absolute count, later frames carry the zigzag-encoded
+ * difference to that reference instead, usually 1 byte, plus the low byte
+ * of the reference. The decoder only applies the difference if its last
+ * absolute count has the same low byte, otherwise it drops that value,
+ * e.g. if a frame was lost between gateway and decoder. At least every 
+ * REPORT_FRAME_KEY frames, the absolute count is sent in full again, 
+ * so the decoder gets back in step. All other values don't depend on 
+ * earlier frames, so a lost packet only loses its own values.
+ *
+ * This header is shared by the firmware and the decoder in tools/gasframe,
+ * so it must not depend on anything AVR specific.
+ */
+
+#ifndef _REPORTFRAME_H
+#define _REPORTFRAME_H
+
+#include <stdint.h>
+
+#include "NodeDefs.h"
+
+#define REPORT_FRAME_VERSION	1		// all values in full
+#define REPORT_FRAME_DELTA		2		// absolute count as difference to a reference
+#define REPORT_FRAME_KEY		16		// absolute count in full at least every this many frames
+#define REPORT_FRAME_TYPE		48		// V_CUSTOM
+#define REPORT_FRAME_MAX		25		// max. MySensors payload with nRF24
+
+/// values that can be carried in a frame, also their order within the frame
+enum ReportField {
+	RF_REL_COUNT = 0,	///< pulses since last report
+	RF_ABS_COUNT,		///< absolute pulse count
+	RF_FLOW,			///< flow in l/h
+	RF_VOLUME,			///< volume in l
+	RF_VCC,				///< battery voltage in mV
+	RF_LIGHT,			///< light level in 0.01%
+	RF_TEMPERATURE,		///< temperature in 0.1°C, signed
+	RF_HUMIDITY,		///< relative humidity in %
+	RF_NUM_FIELDS
+};
+
+/// MySensors message that a frame field replaces
+struct ReportTopic
+{
+	uint8_t sensor;			///< child sensor id
+	uint8_t type;			///< V_xxx variable type
+	uint8_t decimals;		///< value is sent as fixed point with this many decimals
+	bool isSigned;			///< value is zigzag-encoded
+};
+
+constexpr ReportTopic reportTopics[RF_NUM_FIELDS] = {
+	{ SENSOR_ID_GAS,	25, 0, false },	// RF_REL_COUNT		V_VAR2
+	{ SENSOR_ID_GAS,	24, 0, false },	// RF_ABS_COUNT		V_VAR1
+	{ SENSOR_ID_GAS,	34, 0, false },	// RF_FLOW			V_FLOW
+	{ SENSOR_ID_GAS,	35, 0, false },	// RF_VOLUME		V_VOLUME
+	{ SENSOR_ID_VCC,	38, 0, false },	// RF_VCC			V_VOLTAGE
+	{ SENSOR_ID_LIGHT,	23, 2, false },	// RF_LIGHT			V_LIGHT_LEVEL
+	{ SENSOR_ID_TEMPERATURE, 0, 1, true },	// RF_TEMPERATURE	V_TEMP
+	{ SENSOR_ID_HUMIDITY,	1, 0, false },	// RF_HUMIDITY		V_HUM
+};
+
+inline uint32_t zigzagEncode( int32_t v ) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t zigzagDecode( uint32_t u ) { return (int32_t)(u >> 1) ^ -(int32_t)(u & 1); }
+
+
+/**
+ * @brief Collects values during one wake period, then packs them into frames.
+ */
+class ReportFrame
+{
+	public:
+		ReportFrame() : _present(0), _ref(0), _refValid(false), _deltas(0), _packedAbs(false) {}
+
+		void set( ReportField field, uint32_t value );
+		void setSigned( ReportField field, int32_t value ) { set(field, zigzagEncode(value)); }
+		bool empty() const { return _present == 0; }
+		uint8_t pack( uint8_t *buf, uint8_t size );
+		void sent( bool ok );
+
+	private:
+		uint32_t _value[RF_NUM_FIELDS];
+		uint8_t _present;			// bit n set if field n has a value
+		uint32_t _ref;				// absolute count in last acknowledged frame
+		bool _refValid;				// _ref is known to the gateway
+		uint8_t _deltas;			// acknowledged delta frames since _ref was sent in full
+		bool _packedAbs;			// last frame packed has the absolute count ...
+		bool _packedDelta;			// ... as difference to _ref
+		uint32_t _packedValue;		// ... of this value
+};
+
+#endif // _REPORTFRAME_H
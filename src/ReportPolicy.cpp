@@ -0,0 +1,85 @@
+/**
+ * @file 		  ReportPolicy.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Report-on-change with deadband, min. spacing and max. silence, 
+ * see ReportPolicy.h
+ */
+
+#include <stdint.h>
+
+#include "ReportPolicy.h"
+
+
+/**
+ * @brief Has the value changed by more than the deadband since the last 
+ * report? Always true if nothing has been reported yet.
+ */
+bool ReportChannel::changed( int32_t value ) const
+{
+	if (!_valid) return true;
+	uint32_t diff = (value > _value) ? (uint32_t)(value - _value) : (uint32_t)(_value - value);
+	if (_policy.percent) {
+		uint32_t base = (_value < 0) ? (uint32_t)-_value : (uint32_t)_value;
+		return diff * 100u > base * _policy.deadband;
+	}
+	return diff > _policy.deadband;
+}
+
+
+/**
+ * @brief Earliest time the next report may be sent.
+ *
+ * @param now 	current time in ms, returned if there is no restriction
+ * @param fast 	true if flow is high, use `fastSpacing`
+ */
+uint32_t ReportChannel::earliest( uint32_t now, bool fast ) const
+{
+	if (!_valid) return now;
+	uint32_t spacing = (fast && _policy.fastSpacing) ? _policy.fastSpacing : _policy.minSpacing;
+	if ((uint32_t)(now - _tSent) >= spacing) return now;
+	return _tSent + spacing;
+}
+
+
+/**
+ * @brief Should the value be reported now?
+ *
+ * @param value current value
+ * @param now 	current time in ms
+ * @param fast 	true if flow is high, use `fastSpacing`
+ */
+bool ReportChannel::check( int32_t value, uint32_t now, bool fast ) const
+{
+	if (!_valid) return true;
+	if (_policy.maxSilence && (uint32_t)(now - _tSent) >= _policy.maxSilence) return true;
+	return changed(value) && earliest(now, fast) == now;
+}
+
+
+/**
+ * @brief Remember that the value has been reported.
+ */
+void ReportChannel::sent( int32_t value, uint32_t now )
+{
+	_valid = true;
+	_value = value;
+	_tSent = now;
+}
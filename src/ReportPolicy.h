@@ -0,0 +1,64 @@
+/**
+ * @file 		  ReportPolicy.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _REPORTPOLICY_H
+#define _REPORTPOLICY_H
+
+#include <stdint.h>
+
+/**
+ * @brief When to report a value: only if it has changed by more than a
+ * deadband, not more often than every `minSpacing`, but at least every 
+ * `maxSilence`, so the controller knows the node is alive.
+ */
+struct ReportPolicy
+{
+	uint16_t deadband;		///< report if value changed by more than this
+	bool percent;			///< deadband is in % of the last reported value
+	uint32_t minSpacing;	///< min. time between reports, in ms
+	uint32_t fastSpacing;	///< min. time between reports while flow is high, 0 = same as minSpacing
+	uint32_t maxSilence;	///< report unchanged value after this time, in ms, 0 = never
+};
+
+
+/**
+ * @brief Last reported value of one channel, and the policy for reporting it.
+ */
+class ReportChannel
+{
+	public:
+		ReportChannel( const ReportPolicy &policy ) : _policy(policy), _valid(false) {}
+
+		bool changed( int32_t value ) const;
+		bool check( int32_t value, uint32_t now, bool fast=false ) const;
+		void sent( int32_t value, uint32_t now );
+		uint32_t earliest( uint32_t now, bool fast=false ) const;
+		/// time when an unchanged value must be reported, if maxSilence != 0
+		uint32_t heartbeat() const { return _tSent + _policy.maxSilence; }
+		const ReportPolicy& policy() const { return _policy; }
+
+	private:
+		const ReportPolicy &_policy;
+		bool _valid;			// a value has been reported
+		int32_t _value;			// last value reported
+		uint32_t _tSent;		// time of last report, in ms
+};
+
+#endif // _REPORTPOLICY_H
@@ -0,0 +1,68 @@
+/**
+ * @file 		  TxPower.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _SENSORSET_H
+#define _SENSORSET_H
+
+#include <stdint.h>
+
+/**
+ * @brief Optional sensors of a node, assembled at compile time.
+ *
+ * A sensor is a class with static functions
+ *	preHwInit()		configure pins, called from preHwInit()
+ *	present()		present child sensors to the controller
+ *	begin()			initialize hardware, called from setup()
+ *	apply(t_now)	schedule its task(s) with the current intervals
+ * The node declares its sensors as `SensorSet<A,B,...>`, where a sensor 
+ * not built into this variant is replaced by NoSensor with `Select<>`. 
+ * All calls are resolved at compile time, and unused sensors leave no code 
+ * or data in the build, as long as their data are static members of a 
+ * class template.
+ */
+
+/// type A if C is true, otherwise type B, like std::conditional
+template<bool C, class A, class B> struct Select { typedef A type; };
+template<class A, class B> struct Select<false,A,B> { typedef B type; };
+
+
+/// placeholder for a sensor that is not built into this variant
+struct NoSensor
+{
+	static void preHwInit() {}
+	static void present() {}
+	static void begin() {}
+	static void apply( uint32_t ) {}
+};
+
+
+template<class... S> struct SensorSet;
+
+template<> struct SensorSet<> : NoSensor {};
+
+template<class S, class... R> struct SensorSet<S,R...>
+{
+	static void preHwInit() 		{ S::preHwInit(); SensorSet<R...>::preHwInit(); }
+	static void present() 			{ S::present(); SensorSet<R...>::present(); }
+	static void begin() 			{ S::begin(); SensorSet<R...>::begin(); }
+	static void apply( uint32_t t ) { S::apply(t); SensorSet<R...>::apply(t); }
+};
+
+#endif // _SENSORSET_H
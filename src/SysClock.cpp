@@ -0,0 +1,118 @@
+/**
+ * @file 		  SysClock.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief CPU clock prescaler, and calibration of the internal RC oscillator
+ * against the 32768 Hz watch crystal of Timer2.
+ *
+ * The factory calibration of the RC oscillator is good for ±10%, and it
+ * drifts with temperature and supply voltage. The UART needs better than
+ * ±2%. Timer1 counts CPU cycles while Timer2 counts crystal cycles, and 
+ * OSCCAL is moved one step at a time, until the error changes sign.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "XtalTimer.h"
+#include "SysClock.h"
+
+#define CAL_TOSC	64		// measure over at least this many crystal cycles, ~2ms
+#define CAL_STEPS	16		// max. OSCCAL steps per calibration
+
+#ifdef __AVR__
+
+/**
+ * @brief Count CPU cycles for a whole number of Timer2 counts.
+ * Interrupts are disabled for up to 2 Timer2 counts, or 3.9 ms with the
+ * slowest rate used, which is shorter than a Timer2 period, so no tick is lost.
+ *
+ * @param expected 	returns the number of cycles at exactly F_CPU
+ * @return CPU cycles counted
+ */
+static uint16_t measureCycles( uint16_t &expected )
+{
+	uint16_t prescaler = timer2.get_rate().unit / 1000;
+	uint8_t counts = (prescaler < CAL_TOSC) ? CAL_TOSC / prescaler : 1;
+	expected = (uint16_t)(F_CPU * (uint16_t)(counts * prescaler) / XTAL_FREQ);
+
+	uint16_t cycles;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// start at a Timer2 edge, so the measurement is not off by a fraction of a count
+		uint8_t t2 = TCNT2;
+		while (TCNT2 == t2) {}
+		uint16_t t1 = TCNT1;
+		for (uint8_t i=0; i<counts; i++) {
+			t2 = TCNT2;
+			while (TCNT2 == t2) {}
+		}
+		cycles = TCNT1 - t1;
+	}
+	return cycles;
+}
+#endif
+
+
+/**
+ * @brief Adjust OSCCAL, so the CPU clock is as close as possible to F_CPU.
+ * Call at full speed, with Timer2 running, when the UART is idle.
+ * Uses Timer1 briefly, unless that counts something else than CPU cycles.
+ *
+ * No CPU cycle model in the host-native simulation, there it does nothing.
+ *
+ * @return remaining error in 0.1%, >0 if the clock is too fast
+ */
+int16_t calibrateOsc()
+{
+#ifdef __AVR__
+	uint8_t prr = PRR;
+	uint8_t tccr = TCCR1B;
+	PRR &= ~_BV(PRTIM1);
+	TCCR1B = _BV(CS10);					// clk/1, free running (or was already)
+
+	uint8_t best = OSCCAL;
+	int16_t bestErr = 0;
+	uint16_t bestAbs = 0xFFFF;
+	for (uint8_t i=0; i<CAL_STEPS; i++) {
+		uint16_t expected;
+		int16_t err = (int16_t)(measureCycles(expected) - expected);
+		uint16_t e = abs(err);
+		if (e >= bestAbs) break;		// got worse, the previous step was closest
+		best = OSCCAL;
+		bestAbs = e;
+		bestErr = (int32_t)err * 1000 / (int16_t)expected;
+		if (err == 0) break;
+		// two overlapping ranges 0..127 and 128..255, don't step across
+		uint8_t cal = OSCCAL;
+		if (err > 0 ? (cal & 0x7F) == 0 : (cal & 0x7F) == 0x7F) break;
+		OSCCAL = (err > 0) ? cal-1 : cal+1;
+	}
+	OSCCAL = best;
+
+	TCCR1B = tccr;
+	PRR = prr;
+	return bestErr;
+#else
+	return 0;
+#endif
+}
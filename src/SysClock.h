@@ -0,0 +1,45 @@
+/**
+ * @file 		  SysClock.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _SYSCLOCK_H
+#define _SYSCLOCK_H
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/power.h>
+
+#define CLOCK_SLOW	clock_div_8		// 1 MHz from the 8 MHz RC oscillator
+
+/**
+ * @brief Run the CPU at F_CPU, as needed by everything whose timing is
+ * derived from F_CPU: UART, SPI, TWI, ADC prescaler and delay loops.
+ */
+inline void clockFast() { clock_prescale_set(clock_div_1); }
+
+/**
+ * @brief Run the CPU at a fraction of F_CPU, where only code runs that 
+ * doesn't depend on the clock, i.e. the Timer2 ISR polling the contacts.
+ * Must not be called while the UART is still sending.
+ */
+inline void clockSlow() { clock_prescale_set(CLOCK_SLOW); }
+
+int16_t calibrateOsc();
+
+#endif // _SYSCLOCK_H
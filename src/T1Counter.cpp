@@ -0,0 +1,83 @@
+/**
+ * @file 		  T1Counter.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Count pulses at T1 (PD5) with Timer1, see T1Counter.h
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "T1Counter.h"
+
+T1Counter t1Counter;
+
+
+/**
+ * @brief Start Timer1 as a counter of falling edges at T1. 
+ * The pin must be an input with pull-up.
+ */
+void T1Counter::begin()
+{
+	PRR &= ~_BV(PRTIM1);
+	TIMSK1 = 0;
+	TCCR1A = 0;							// normal mode
+	TCCR1B = _BV(CS12) | _BV(CS11);		// clock from T1, falling edge
+	TCNT1 = 0;
+	_last = 0;
+	_woken = false;
+	PCMSK2 |= _BV(PCINT21);				// T1 = PD5, each edge wakes the CPU
+	PCIFR = _BV(PCIF2);
+	PCICR |= _BV(PCIE2);
+	watch();
+}
+
+
+/**
+ * @brief Pulses counted since the last call.
+ * Must be called before 65536 pulses have been counted.
+ */
+uint16_t T1Counter::take()
+{
+	uint16_t count;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		count = TCNT1;
+		_woken = false;
+	}
+	uint16_t n = count - _last;
+	_last = count;
+	return n;
+}
+
+
+/**
+ * @brief Let the next pulse after the last take() wake loop(). 
+ * If there has been one already, woken() is true right away.
+ */
+void T1Counter::watch()
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		OCR1A = _last + 1;
+		TIFR1 = _BV(OCF1A);
+		TIMSK1 |= _BV(OCIE1A);
+		if (TCNT1 != _last) compareMatch();		// counted before OCR1A was set
+	}
+}
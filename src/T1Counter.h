@@ -0,0 +1,62 @@
+/**
+ * @file 		  T1Counter.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _T1COUNTER_H
+#define _T1COUNTER_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/**
+ * @brief Timer1 as a hardware counter of falling edges at T1 (PD5), so 
+ * loop() only wakes up for the first pulse after each report.
+ *
+ * Timer1 samples T1 with the I/O clock, which stops in SLEEP_MODE_PWR_SAVE.
+ * The pin change interrupt for PD5 stays armed, so each edge wakes the CPU
+ * just long enough for Timer1's edge detector, which still holds the level
+ * it sampled before, to count it, and the CPU goes back to power-save sleep.
+ * The compare match interrupt at OCR1A = next count wakes loop() once, 
+ * with the first pulse after watch(); further pulses are left in TCNT1 
+ * until the next report, see countMeters().
+ * There is no debouncing, so only for clean signals like an S0 output.
+ */
+class T1Counter
+{
+	public:
+		void begin();
+		uint16_t take();
+		void watch();
+		/// woken by the compare match interrupt, pulses should be taken over
+		bool woken() const { return _woken; }
+		/// call from TIMER1_COMPA ISR
+		void compareMatch()
+		{
+			TIMSK1 &= ~_BV(OCIE1A);
+			_woken = true;
+		}
+
+	private:
+		volatile bool _woken;		// pulses counted since watch()
+		uint16_t _last;				// TCNT1 at last take()
+};
+
+extern T1Counter t1Counter;
+
+#endif // _T1COUNTER_H
@@ -0,0 +1,196 @@
+/**
+ * @file 		  Twi.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Interrupt-driven I2C master, for register access to the BME280.
+ *
+ * A transfer writes txLen bytes (typically a register address, and data), 
+ * then, after a repeated start, reads rxLen bytes. It runs entirely in the 
+ * TWI ISR, so the CPU can sleep in SLEEP_MODE_IDLE meanwhile (twiWait()), 
+ * or do something else and be told by a callback. The TWI is only powered 
+ * (PRTWI in PRR) from twiStart() until the STOP condition has been sent.
+ * Buffers must remain valid until the transfer has completed.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/twi.h>
+
+#include "Twi.h"
+
+#define TWI_GO		(_BV(TWEN) | _BV(TWIE) | _BV(TWINT))	// next bus action
+
+static volatile bool busy = false;
+static volatile uint8_t status = TWI_OK;
+static uint8_t sla;
+static const uint8_t *txData;
+static uint8_t txCount;
+static uint8_t *rxData;
+static uint8_t rxCount;
+static uint8_t pos;
+static bool reading;
+static twi_callback_t callback;
+
+
+/**
+ * @brief Start a transfer, don't wait for it to complete.
+ *
+ * @param addr 	7-bit I2C address
+ * @param tx 	bytes to write, e.g. register address and data
+ * @param txLen number of bytes to write, may be 0
+ * @param rx 	buffer for bytes read
+ * @param rxLen number of bytes to read, may be 0
+ * @param done 	called from ISR when complete, may be NULL
+ * @return false if another transfer is still running
+ */
+bool twiStart( uint8_t addr, const uint8_t *tx, uint8_t txLen, 
+			   uint8_t *rx, uint8_t rxLen, twi_callback_t done )
+{
+	if (busy) return false;
+	sla = addr << 1;
+	txData = tx;
+	txCount = txLen;
+	rxData = rx;
+	rxCount = rxLen;
+	pos = 0;
+	reading = (txLen == 0 && rxLen != 0);
+	callback = done;
+	busy = true;
+
+	// registers must be initialized again after power reduction
+	PRR &= ~_BV(PRTWI);
+	TWSR = 0;								// prescaler 1
+	TWBR = ((F_CPU / TWI_FREQ) - 16) / 2;
+	TWCR = TWI_GO | _BV(TWSTA);
+	return true;
+}
+
+
+/**
+ * @brief Is a transfer still running? While it is, the CPU must not enter 
+ * a sleep mode deeper than SLEEP_MODE_IDLE.
+ */
+bool twiBusy()
+{
+	return busy;
+}
+
+
+/**
+ * @brief Sleep in SLEEP_MODE_IDLE until the current transfer has completed.
+ *
+ * @return status of the transfer, TWI_OK if successful
+ */
+uint8_t twiWait()
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	cli();
+	while (busy) {
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		cli();
+	}
+	sei();
+	return status;
+}
+
+
+/**
+ * @brief Complete transfer, and wait for it.
+ * 
+ * @return status of the transfer, TWI_OK if successful
+ */
+uint8_t twiTransfer( uint8_t addr, const uint8_t *tx, uint8_t txLen, uint8_t *rx, uint8_t rxLen )
+{
+	twiWait();
+	twiStart(addr, tx, txLen, rx, rxLen);
+	return twiWait();
+}
+
+
+/**
+ * @brief Send STOP, power down the TWI and report the result.
+ */
+static void twiStop( uint8_t result )
+{
+	TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+	while (TWCR & _BV(TWSTO)) {}			// a few us
+	TWCR = 0;
+	PRR |= _BV(PRTWI);
+	status = result;
+	busy = false;
+	if (callback) callback(result);
+}
+
+
+ISR(TWI_vect)
+{
+	switch (TW_STATUS) {
+		case TW_START:
+		case TW_REP_START:
+			TWDR = sla | (reading ? TW_READ : TW_WRITE);
+			TWCR = TWI_GO;
+			break;
+
+		case TW_MT_SLA_ACK:
+		case TW_MT_DATA_ACK:
+			if (pos < txCount) {
+				TWDR = txData[pos++];
+				TWCR = TWI_GO;
+			} else if (rxCount) {
+				reading = true;
+				pos = 0;
+				TWCR = TWI_GO | _BV(TWSTA);
+			} else {
+				twiStop(TWI_OK);
+			}
+			break;
+
+		case TW_MR_DATA_ACK:
+			rxData[pos++] = TWDR;
+			// fall through
+		case TW_MR_SLA_ACK:
+			// ACK all bytes except the last one
+			TWCR = (pos + 1 < rxCount) ? (TWI_GO | _BV(TWEA)) : TWI_GO;
+			break;
+
+		case TW_MR_DATA_NACK:
+			rxData[pos++] = TWDR;
+			twiStop(TWI_OK);
+			break;
+
+		case TW_MT_SLA_NACK:
+		case TW_MR_SLA_NACK:
+			twiStop(TWI_NACK_ADDR);
+			break;
+
+		case TW_MT_DATA_NACK:
+			twiStop(TWI_NACK_DATA);
+			break;
+
+		default:
+			twiStop(TWI_ERROR);
+			break;
+	}
+}
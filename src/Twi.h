@@ -0,0 +1,47 @@
+/**
+ * @file 		  Twi.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _TWI_H
+#define _TWI_H
+
+#include <stdint.h>
+
+#ifndef TWI_FREQ
+ #define TWI_FREQ	100000uL	// SCL frequency in Hz
+#endif
+
+/// result of a transfer, same codes as Wire.endTransmission()
+enum {
+	TWI_OK = 0,
+	TWI_NACK_ADDR = 2,		///< no device at this address
+	TWI_NACK_DATA = 3,		///< device did not accept data
+	TWI_ERROR = 4,			///< bus error, arbitration lost
+};
+
+/// called from the TWI ISR when a transfer has completed
+typedef void (*twi_callback_t)(uint8_t status);
+
+bool twiStart( uint8_t addr, const uint8_t *tx, uint8_t txLen, 
+			   uint8_t *rx, uint8_t rxLen, twi_callback_t done=0 );
+bool twiBusy();
+uint8_t twiWait();
+uint8_t twiTransfer( uint8_t addr, const uint8_t *tx, uint8_t txLen, uint8_t *rx, uint8_t rxLen );
+
+#endif // _TWI_H
@@ -0,0 +1,80 @@
+/**
+ * @file 		  TxPower.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Adaptive transmit power level, see TxPower.h
+ */
+
+#include <stdint.h>
+
+#include "TxPower.h"
+
+
+/**
+ * @brief Start at the highest level, and work down from there.
+ *
+ * @param minLevel 	lowest power level to use
+ * @param maxLevel 	highest power level to use
+ */
+TxPower::TxPower( uint8_t minLevel, uint8_t maxLevel )
+	: _min(minLevel), _max(maxLevel), _level(maxLevel), _probing(false),
+	  _streak(0), _needed(TXP_STEP_DOWN), _sent(0), _failed(0)
+{
+}
+
+
+/**
+ * @brief Record result of one message, and adjust power level.
+ *
+ * @param ok 	true if message was acknowledged by the next node
+ * @return true if the power level has changed
+ */
+bool TxPower::result( bool ok )
+{
+	_sent++;
+	if (ok) {
+		if (_streak < 0xFFFF) _streak++;
+		if (_probing && _streak >= TXP_PROBE) {
+			// lower level works
+			_probing = false;
+			_needed = TXP_STEP_DOWN;
+		}
+		if (!_probing && _streak >= _needed && _level > _min) {
+			_level--;
+			_streak = 0;
+			_probing = true;
+			return true;
+		}
+		return false;
+	}
+
+	_failed++;
+	_streak = 0;
+	if (_probing) {
+		// lower level doesn't work, wait longer before trying again
+		_probing = false;
+		if (_needed < TXP_BACKOFF_MAX) _needed *= 2;
+	}
+	if (_level < _max) {
+		_level++;
+		return true;
+	}
+	return false;
+}
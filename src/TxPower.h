@@ -0,0 +1,62 @@
+/**
+ * @file 		  TxPower.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _TXPOWER_H
+#define _TXPOWER_H
+
+#include <stdint.h>
+
+#define TXP_STEP_DOWN	32		// successful messages in a row before trying a lower level
+#define TXP_PROBE		8		// successful messages at a new lower level to accept it
+#define TXP_BACKOFF_MAX	1024	// max. messages in a row before trying a lower level again
+
+/**
+ * @brief Choose the lowest transmit power level that still gets messages 
+ * through, from the results of the messages sent.
+ *
+ * After a failure, the level goes up by one. After TXP_STEP_DOWN successful 
+ * messages in a row, the next lower level is tried. If that fails within 
+ * TXP_PROBE messages, the level goes back up, and the next attempt is only 
+ * made after twice as many successful messages.
+ */
+class TxPower
+{
+	public:
+		TxPower( uint8_t minLevel, uint8_t maxLevel );
+
+		bool result( bool ok );
+		/// current power level, between minLevel and maxLevel
+		uint8_t level() const { return _level; }
+		/// number of messages sent
+		uint16_t sent() const { return _sent; }
+		/// number of messages not acknowledged
+		uint16_t failed() const { return _failed; }
+
+	private:
+		uint8_t _min, _max;
+		uint8_t _level;
+		bool _probing;			// level was lowered, not yet confirmed
+		uint16_t _streak;		// successful messages in a row
+		uint16_t _needed;		// successful messages in a row before stepping down
+		uint16_t _sent;
+		uint16_t _failed;
+};
+
+#endif // _TXPOWER_H
@@ -0,0 +1,80 @@
+/**
+ * @file 		  VccMeter.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Supply voltage measurement in two steps, so the CPU doesn't have 
+ * to wait for the bandgap reference to settle.
+ *
+ * startVCC() turns on the 1.1V bandgap reference and selects it as ADC 
+ * input, with AVCC as reference, and returns with the ADC still off. 
+ * collectVCC(), called at least VCC_SETTLE_TIME later, typically in the 
+ * next wake period, turns on the ADC, converts with the CPU asleep, and 
+ * turns the ADC and the bandgap off again. If the ADC was used for 
+ * something else in between (e.g. light level), collectVCC() returns 0, 
+ * and the measurement must be started again.
+ *
+ * The bandgap is kept on through the analog comparator (ACBG), which 
+ * works with the comparator itself disabled. While the CPU sleeps in 
+ * between, only the bandgap draws current, not the ADC.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "LuxMeter.h"
+#include "VccMeter.h"
+
+#define BANDGAP_MV	1100uL
+#define VCC_ADMUX	((1 << REFS0) | (14 << MUX0))	// ref = AVCC, input = bandgap
+
+
+/**
+ * @brief Turn on bandgap and select it as ADC input, leave the ADC off.
+ */
+void startVCC()
+{
+	ACSR |= _BV(ACBG);					// bandgap on, comparator stays disabled
+	PRR &= ~_BV(PRADC);					// ADMUX can't be written with the ADC clock off
+	ADMUX = VCC_ADMUX;
+	PRR |= _BV(PRADC);
+}
+
+
+/**
+ * @brief Measure supply voltage, then power down ADC and bandgap.
+ *
+ * @return VCC in mV, or 0 if the ADC has been reconfigured since startVCC()
+ */
+uint16_t collectVCC()
+{
+	uint16_t mv = 0;
+
+	PRR &= ~_BV(PRADC);
+	if ((ACSR & _BV(ACBG)) && ADMUX == VCC_ADMUX) {
+		ADCSRA |= _BV(ADEN) | _BV(ADIE);	// keep prescaler set by basicHwInit()
+		adcConvertAsleep();				// first conversion after enabling the ADC, ignore it
+		uint16_t adc = adcConvertAsleep();
+		if (adc) mv = (uint16_t)(BANDGAP_MV * 1024uL / adc);
+	}
+	ADCSRA &= ~(_BV(ADEN) | _BV(ADIE));
+	PRR |= _BV(PRADC);
+	ACSR &= ~_BV(ACBG);
+	return mv;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file 		  VccMeter.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _VCCMETER_H
+#define _VCCMETER_H
+
+#include <stdint.h>
+
+#define VCC_SETTLE_TIME	10		// ms from startVCC() to collectVCC()
+
+void startVCC();
+uint16_t collectVCC();
+
+#endif // _VCCMETER_H
@@ -0,0 +1,135 @@
+/**
+ * @file 		  XtalTimer.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Timer2 in asynchronous mode, clocked from a 32768 Hz watch crystal,
+ * with variable interrupt rate.
+ *
+ * A rate change requested with set_rate() is applied at an interrupt, right
+ * after the callback, when TCNT2 has just been cleared, so no partial period
+ * is lost. Called from the callback, it already affects the period that has
+ * just started. restart()
+ * changes the rate immediately, e.g. from a pin change ISR, and accounts for
+ * the part of the current period that has already elapsed.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "XtalTimer.h"
+
+XtalTimer timer2;
+
+#define ASSR_BUSY	(_BV(TCN2UB) | _BV(OCR2AUB) | _BV(OCR2BUB) | _BV(TCR2AUB) | _BV(TCR2BUB))
+
+
+/**
+ * @brief Configure Timer2 for asynchronous operation, but don't start it yet.
+ * The ISR is defined by the application, see XtalTimer.h
+ *
+ * @param rate 		initial interrupt rate, see xtalRate()
+ */
+void XtalTimer::begin( const XtalRate &rate )
+{
+	_rate = _next = rate;
+	_pending = false;
+	_millis = 0;
+	_frac = 0;
+
+	// procedure from ATmega328P datasheet, 22.9 "Asynchronous Operation of Timer/Counter2"
+	PRR &= ~_BV(PRTIM2);
+	TIMSK2 = 0;
+	ASSR = _BV(AS2);				// clock from crystal at TOSC1/TOSC2
+	TCNT2 = 0;
+	OCR2A = rate.ocr;
+	TCCR2A = _BV(WGM21);			// CTC mode, TOP = OCR2A
+	TCCR2B = 0;						// stopped until start()
+	sync();
+	TIFR2 = _BV(OCF2A) | _BV(OCF2B) | _BV(TOV2);
+}
+
+
+/**
+ * @brief Start counting and enable the compare match interrupt.
+ */
+void XtalTimer::start()
+{
+	TCCR2B = _rate.cs;
+	sync();
+	TIFR2 = _BV(OCF2A);
+	TIMSK2 = _BV(OCIE2A);
+}
+
+
+/**
+ * @brief Wait until writes to asynchronous Timer2 registers have completed.
+ * Must be called before entering power-save sleep.
+ */
+void XtalTimer::sync()
+{
+	while (ASSR & ASSR_BUSY) {}
+}
+
+
+/**
+ * @brief Change interrupt rate, starting with the next interrupt, or with 
+ * the current period if called from the callback.
+ */
+void XtalTimer::set_rate( const XtalRate &rate )
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		set_rate_isr(rate);
+	}
+}
+
+
+/**
+ * @brief Change interrupt rate now, and restart the current period.
+ * Call from an ISR or with interrupts disabled.
+ */
+void XtalTimer::restart( const XtalRate &rate )
+{
+	// after wake-up, TCNT2 may only be read after one TOSC1 cycle
+	OCR2B = 0;
+	while (ASSR & _BV(OCR2BUB)) {}
+	uint32_t f = _frac + TCNT2 * _rate.unit;
+	_millis += f >> 15;
+	_frac = f & 0x7FFF;
+
+	TCNT2 = 0;
+	_next = rate;
+	apply(rate);
+}
+
+
+/**
+ * @brief Get milliseconds since start(), updated at every interrupt.
+ */
+uint32_t XtalTimer::get_millis()
+{
+	uint32_t ms;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ms = _millis;
+	}
+	return ms;
+}
+
@@ -0,0 +1,139 @@
+/**
+ * @file 		  XtalTimer.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#ifndef _XTALTIMER_H
+#define _XTALTIMER_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define XTAL_FREQ	32768uL		// watch crystal at TOSC1/TOSC2
+
+/**
+ * @brief Timer2 configuration for one interrupt rate, computed at compile time,
+ * so changing the rate from an ISR is cheap.
+ */
+struct XtalRate
+{
+	uint8_t cs;			///< clock select bits CS22:CS20
+	uint8_t ocr;		///< OCR2A value, period is ocr+1 counts
+	uint32_t unit;		///< one count in 1/32768 ms, i.e. prescaler * 1000
+	uint32_t incr;		///< one period in 1/32768 ms
+
+	constexpr bool operator==( const XtalRate &r ) const { return cs==r.cs && ocr==r.ocr; }
+	constexpr bool operator!=( const XtalRate &r ) const { return !(*this==r); }
+};
+
+
+/**
+ * @brief Timer2 settings closest to the requested interrupt rate,
+ * using the smallest possible prescaler
+ *
+ * @param hz  interrupt rate in Hz, 1 ... 16384
+ */
+constexpr XtalRate xtalRate( uint16_t hz )
+{
+	const uint16_t prescalers[] = { 1, 8, 32, 64, 128, 256, 1024 };
+	uint8_t i = 0;
+	while (i < 6 && (XTAL_FREQ / prescalers[i] + hz/2) / hz > 256) i++;
+	uint32_t counts = (XTAL_FREQ / prescalers[i] + hz/2) / hz;
+	if (counts > 256) counts = 256;
+	if (counts < 1) counts = 1;
+	return XtalRate{
+		(uint8_t)(i+1), (uint8_t)(counts-1),
+		(uint32_t)(prescalers[i] * 1000uL), (uint32_t)(prescalers[i] * 1000uL * counts) };
+}
+
+
+/**
+ * @brief Timer2 clocked by the 32768 Hz watch crystal, in CTC mode,
+ * with an interrupt rate that can be changed at run time.
+ *
+ * Milliseconds are accumulated in units of crystal cycles, so get_millis()
+ * is as accurate as the crystal, whatever the interrupt rate.
+ *
+ * The application defines the interrupt handler, and binds its callback at
+ * compile time, so the whole ISR is inlined, without an indirect call that 
+ * would make the compiler save all call-clobbered registers:
+ *
+ *     ISR(TIMER2_COMPA_vect) { timer2.tick<myCallback>(); }
+ */
+class XtalTimer
+{
+	public:
+		void begin( const XtalRate &rate );
+		void start();
+		void set_rate( const XtalRate &rate );
+		/// set_rate() for the tick callback, where interrupts are disabled
+		void set_rate_isr( const XtalRate &rate ) 
+		{
+			if (rate == _next) return;
+			_next = rate;
+			_pending = (rate != _rate);
+		}
+		void restart( const XtalRate &rate );
+		const XtalRate& get_rate() const { return _rate; }
+		uint32_t get_millis();
+		/// milliseconds, for use in an ISR, where interrupts are already disabled
+		uint32_t get_millis_isr() const { return _millis; }
+		void sync();
+
+		/**
+		 * @brief Called from ISR at every compare match: count the time,
+		 * call `callback`, then apply a rate change requested so far.
+		 */
+		template<void (*callback)()>
+		void tick()
+		{
+			uint32_t f = _frac + _rate.incr;
+			_millis += f >> 15;
+			_frac = f & 0x7FFF;
+
+			callback();
+			if (_pending) apply(_next);
+		}
+
+	private:
+		void apply( const XtalRate &rate );
+
+		XtalRate _rate;				// currently active
+		XtalRate _next;				// to become active at next interrupt
+		volatile bool _pending;
+		volatile uint32_t _millis;
+		uint16_t _frac;				// fraction of a millisecond, in 1/32768 ms
+};
+
+extern XtalTimer timer2;
+
+
+/**
+ * @brief Load new rate into Timer2, restarting the async prescaler
+ * so the next period has full length. Inline, because it is used in the ISR.
+ */
+inline void XtalTimer::apply( const XtalRate &rate )
+{
+	GTCCR = _BV(PSRASY);
+	OCR2A = rate.ocr;
+	TCCR2B = rate.cs;
+	_rate = rate;
+	_pending = false;
+}
+
+#endif // _XTALTIMER_H
@@ -27,6 +27,13 @@
 #define MAGNET			D,3,ACTIVE_LOW      // LOW(TRUE) when closed
 #define MAGNET_RET      D,4,ACTIVE_HIGH     // return pin for contact (GND)
 
+// with EXTRA_METERS, more contacts between these pins and MAGNET_RET
+#define WATER_METER		D,6,ACTIVE_LOW      // reed contact of water meter
+#define POWER_METER		D,7,ACTIVE_LOW      // S0+ of electricity meter, S0- to MAGNET_RET
+
+// with T1_COUNTER, S0+ to PD5 = T1 instead, and S0- to GND, counted by Timer1
+#define PULSE_T1		D,5,ACTIVE_LOW
+
 #define DEBUG_ENABLE  _UART_RX  // H if FTDI connected, else L via 1 MOhm pulldown
 
 #endif // PINS_H
@@ -0,0 +1,84 @@
+#!/bin/sh
+# Flash and static RAM used by each PlatformIO environment of the node,
+# and the RAM left for stack and heap (2048 bytes on the ATmega328P), e.g.
+#   tools/envsizes.sh
+# Extra arguments are added to the build flags of all environments, so
+# optional features can be measured too:
+#   tools/envsizes.sh -DPACKED_REPORT=1 -DBACKFILL=1
+# With --rev, another revision is built in a temporary git worktree.
+# With --before, a revision and the working tree are built, and the sizes
+# are printed side by side with the difference, so a change can be
+# measured with one command, given the revision before it, e.g.
+#   tools/envsizes.sh --before main
+# ENVS limits the environments, e.g. ENVS="120 126" tools/envsizes.sh
+
+cd "$(dirname "$0")/.." || exit 1
+AVR_SIZE=${AVR_SIZE:-$HOME/.platformio/packages/toolchain-atmelavr/bin/avr-size}
+[ -x "$AVR_SIZE" ] || AVR_SIZE=avr-size
+
+REV=
+BEFORE=
+if [ "$1" = "--rev" ]; then
+	REV=$2
+	shift 2
+elif [ "$1" = "--before" ]; then
+	BEFORE=$2
+	REV=$2
+	shift 2
+fi
+
+if [ $# -gt 0 ]; then
+	PLATFORMIO_BUILD_FLAGS="$*"
+	export PLATFORMIO_BUILD_FLAGS
+	echo "# build flags: $*"
+fi
+
+RAM_SIZE=2048
+[ -n "$ENVS" ] || ENVS=$(sed -n 's/^\[env:\(.*\)\]/\1/p' platformio.ini)
+
+# one line per environment in the current directory: env flash data bss stack
+sizes()
+{
+	for env in $ENVS; do
+		[ "$env" = native ] && continue
+		if ! pio run -s -e "$env" >/dev/null 2>&1; then
+			printf "%-10s %8s\n" "$env" failed
+			continue
+		fi
+		# .data is initialized RAM, .bss and .noinit are zeroed or left alone
+		"$AVR_SIZE" -A ".pio/build/$env/firmware.elf" | awk -v env="$env" -v ram=$RAM_SIZE '
+			$1 == ".text" 	{ flash += $2 }
+			$1 == ".data" 	{ flash += $2; data = $2 }
+			$1 == ".bss" || $1 == ".noinit" { bss += $2 }
+			END { printf "%-10s %8d %8d %8d %8d\n", env, flash, data, bss, ram - data - bss }'
+	done
+}
+
+if [ -n "$REV" ]; then
+	TREE=$(mktemp -d) || exit 1
+	git worktree add -q --detach "$TREE" "$REV" || exit 1
+	trap 'git worktree remove --force "$TREE"' EXIT
+	echo "# revision: $(git log -1 --format='%h %s' "$REV")"
+fi
+
+if [ -z "$BEFORE" ]; then
+	[ -n "$REV" ] && cd "$TREE"
+	printf "%-10s %8s %8s %8s %8s\n" env flash data bss stack
+	sizes
+	exit 0
+fi
+
+OLD=$(mktemp) || exit 1
+trap 'rm -f "$OLD"; git worktree remove --force "$TREE"' EXIT
+(cd "$TREE" && sizes) > "$OLD"
+echo "# compared with: working tree"
+printf "%-10s %18s %18s %18s\n" "" "flash" "data+bss" "stack"
+printf "%-10s %6s %5s %5s %6s %5s %5s %6s %5s %5s\n" env before after diff before after diff before after diff
+sizes | awk -v old="$OLD" '
+	BEGIN { while ((getline l < old) > 0) { split(l, f); line[f[1]] = l } }
+	{
+		split(line[$1], o)
+		if ($2 == "failed" || o[2] == "failed" || o[2] == "") { printf "%-10s %17s\n", $1, "failed"; next }
+		printf "%-10s %6d %5d %+5d %6d %5d %+5d %6d %5d %+5d\n", $1,
+			o[2], $2, $2 - o[2], o[3] + o[4], $3 + $4, $3 + $4 - o[3] - o[4], o[5], $5, $5 - o[5]
+	}'
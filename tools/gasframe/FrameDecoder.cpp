@@ -0,0 +1,135 @@
+/**
+ * @file 		  FrameDecoder.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "FrameDecoder.h"
+
+
+/**
+ * @brief Convert hex string, as published by the MQTT gateway for custom 
+ * payloads, to bytes.
+ *
+ * @return false if not a valid hex string
+ */
+bool parseHex( const std::string &hex, std::vector<uint8_t> &bytes )
+{
+	bytes.clear();
+	if (hex.size() % 2) return false;
+	for (size_t i=0; i<hex.size(); i+=2) {
+		if (!isxdigit((unsigned char)hex[i]) || !isxdigit((unsigned char)hex[i+1])) 
+			return false;
+		bytes.push_back((uint8_t)std::stoul(hex.substr(i,2), nullptr, 16));
+	}
+	return true;
+}
+
+
+static std::string formatValue( const ReportTopic &topic, uint32_t raw )
+{
+	bool negative = false;
+	unsigned long a = raw;
+	if (topic.isSigned) {
+		int32_t v = zigzagDecode(raw);
+		negative = (v < 0);
+		a = negative ? 0uL - (unsigned long)v : (unsigned long)v;
+	}
+	std::string text = negative ? "-" : "";
+	if (topic.decimals == 0) return text + std::to_string(a);
+
+	unsigned long scale = 1;
+	for (uint8_t i=0; i<topic.decimals; i++) scale *= 10;
+	std::string frac = std::to_string(a % scale);
+	frac.insert(0, topic.decimals - frac.size(), '0');
+	return text + std::to_string(a / scale) + '.' + frac;
+}
+
+
+/**
+ * @brief Decode one frame into the values it carries, in field order.
+ *
+ * The absolute count in a REPORT_FRAME_DELTA frame is a difference to the 
+ * last absolute count in `context`. Without a context, or if its low byte 
+ * doesn't match the frame, that value is left out, and counted in
+ * `context->unresolved`; this is not an error.
+ *
+ * @param buf 		frame as received
+ * @param len 		length of frame
+ * @param values 	receives decoded values
+ * @param error 	if not NULL, receives reason for failure
+ * @param context 	if not NULL, state of the node that sent the frame, updated
+ * @return false if the frame is malformed, `values` then holds what 
+ * 				could be decoded before the error
+ */
+bool decodeFrame( const uint8_t *buf, size_t len, std::vector<DecodedValue> &values, 
+				  std::string *error, FrameContext *context )
+{
+	values.clear();
+	auto fail = [error]( const char *msg ) { 
+		if (error) *error = msg; 
+		return false; 
+	};
+
+	if (len < 2) return fail("frame too short");
+	if (buf[0] != REPORT_FRAME_VERSION && buf[0] != REPORT_FRAME_DELTA) 
+		return fail("unknown frame version");
+	bool delta = (buf[0] == REPORT_FRAME_DELTA);
+
+	uint8_t mask = buf[1];
+	size_t pos = 2;
+	uint8_t refByte = 0;
+	if (delta) {
+		if (pos >= len) return fail("frame too short");
+		refByte = buf[pos++];
+	}
+	for (uint8_t field=0; field<RF_NUM_FIELDS; field++) {
+		if (!(mask & (1u << field))) continue;
+		uint32_t v = 0;
+		uint8_t shift = 0;
+		for (;;) {
+			if (pos >= len) return fail("frame truncated");
+			if (shift > 28) return fail("varint too long");
+			uint8_t b = buf[pos++];
+			v |= (uint32_t)(b & 0x7F) << shift;
+			shift += 7;
+			if (!(b & 0x80)) break;
+		}
+		if (field == RF_ABS_COUNT) {
+			if (delta) {
+				if (!context || !context->valid || (uint8_t)context->absCount != refByte) {
+					if (context) context->unresolved++;
+					continue;
+				}
+				v = context->absCount + (uint32_t)zigzagDecode(v);
+			}
+			if (context) {
+				context->absCount = v;
+				context->valid = true;
+			}
+		}
+		const ReportTopic &topic = reportTopics[field];
+		values.push_back({ (ReportField)field, topic.sensor, topic.type, formatValue(topic, v) });
+	}
+	if (mask >> RF_NUM_FIELDS) return fail("unknown fields");
+	if (pos != len) return fail("extra bytes after last field");
+	return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file 		  FrameDecoder.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Host-side decoder for the binary report frame sent by the gas meter
+ * node with PACKED_REPORT, see src/ReportFrame.h for the format.
+ */
+
+#ifndef _FRAMEDECODER_H
+#define _FRAMEDECODER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ReportFrame.h"
+
+/// one value from a frame, with the MySensors message it stands for
+struct DecodedValue
+{
+	ReportField field;
+	uint8_t sensor;			///< child sensor id
+	uint8_t type;			///< V_xxx variable type
+	std::string payload;	///< value formatted like the original message
+};
+
+/// what the decoder needs to remember about one node, for REPORT_FRAME_DELTA
+struct FrameContext
+{
+	bool valid = false;			///< absCount is known
+	uint32_t absCount = 0;		///< last absolute count decoded
+	unsigned unresolved = 0;	///< differences dropped for lack of a matching reference
+};
+
+bool parseHex( const std::string &hex, std::vector<uint8_t> &bytes );
+
+bool decodeFrame( const uint8_t *buf, size_t len, std::vector<DecodedValue> &values, 
+				  std::string *error=nullptr, FrameContext *context=nullptr );
+
+inline bool decodeFrame( const std::vector<uint8_t> &frame, std::vector<DecodedValue> &values, 
+						 std::string *error=nullptr, FrameContext *context=nullptr )
+{
+	return decodeFrame(frame.data(), frame.size(), values, error, context);
+}
+
+#endif // _FRAMEDECODER_H
@@ -0,0 +1,231 @@
+/**
+ * @file 		  frametest.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Round trip of the report frame encoder in src/ReportFrame.cpp
+ * through the decoder, run with `make check`.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ReportFrame.h"
+#include "FrameDecoder.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if (!(cond)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+
+/// pack one frame, decode it, return the payloads by field, "" if absent
+static std::vector<std::string> roundTrip( ReportFrame &frame, FrameContext *context,
+										   uint8_t size=REPORT_FRAME_MAX, uint8_t *len=nullptr )
+{
+	uint8_t buf[REPORT_FRAME_MAX];
+	uint8_t n = frame.pack(buf, size);
+	if (len) *len = n;
+	std::vector<std::string> byField(RF_NUM_FIELDS);
+	std::vector<DecodedValue> values;
+	std::string error;
+	bool ok = decodeFrame(buf, n, values, &error, context);
+	if (!ok) printf("decode: %s\n", error.c_str());
+	CHECK(ok);
+	for (const DecodedValue &v : values) byField[v.field] = v.payload;
+	return byField;
+}
+
+
+static void testAllFields()
+{
+	ReportFrame frame;
+	frame.set(RF_REL_COUNT, 3);
+	frame.set(RF_ABS_COUNT, 659200);
+	frame.set(RF_FLOW, 1850);
+	frame.set(RF_VOLUME, 6592000);
+	frame.set(RF_VCC, 3012);
+	frame.set(RF_LIGHT, 4207);
+	frame.setSigned(RF_TEMPERATURE, 215);
+	frame.set(RF_HUMIDITY, 55);
+	auto v = roundTrip(frame, nullptr);
+	CHECK(v[RF_REL_COUNT] == "3");
+	CHECK(v[RF_ABS_COUNT] == "659200");
+	CHECK(v[RF_FLOW] == "1850");
+	CHECK(v[RF_VOLUME] == "6592000");
+	CHECK(v[RF_VCC] == "3012");
+	CHECK(v[RF_LIGHT] == "42.07");
+	CHECK(v[RF_TEMPERATURE] == "21.5");
+	CHECK(v[RF_HUMIDITY] == "55");
+	CHECK(frame.empty());
+}
+
+
+static void testNegativeTemperature()
+{
+	const int32_t temps[] = { -1, -5, -10, -99, -215, -2000, 0, 1 };
+	const char *texts[] = { "-0.1", "-0.5", "-1.0", "-9.9", "-21.5", "-200.0", "0.0", "0.1" };
+	for (unsigned i=0; i<sizeof(temps)/sizeof(temps[0]); i++) {
+		CHECK(zigzagDecode(zigzagEncode(temps[i])) == temps[i]);
+		ReportFrame frame;
+		frame.setSigned(RF_TEMPERATURE, temps[i]);
+		auto v = roundTrip(frame, nullptr);
+		CHECK(v[RF_TEMPERATURE] == texts[i]);
+	}
+	CHECK(zigzagEncode(-1) == 1);
+	CHECK(zigzagEncode(INT32_MIN) == UINT32_MAX);
+	CHECK(zigzagDecode(UINT32_MAX) == INT32_MIN);
+}
+
+
+/// a field that doesn't fit is left for the next frame, smaller ones still go first
+static void testOverflow()
+{
+	ReportFrame frame;
+	frame.set(RF_REL_COUNT, 3);						// 1 byte
+	frame.set(RF_ABS_COUNT, 0xFFFFFFFF);			// 5 bytes
+	frame.set(RF_VCC, 3012);						// 2 bytes
+	uint8_t len;
+	auto v = roundTrip(frame, nullptr, 2+1+2+1, &len);
+	CHECK(len == 5);
+	CHECK(v[RF_REL_COUNT] == "3");
+	CHECK(v[RF_ABS_COUNT] == "");
+	CHECK(v[RF_VCC] == "3012");
+	CHECK(!frame.empty());
+	v = roundTrip(frame, nullptr, REPORT_FRAME_MAX, &len);
+	CHECK(len == 7);
+	CHECK(v[RF_ABS_COUNT] == "4294967295");
+	CHECK(v[RF_REL_COUNT] == "");
+	CHECK(frame.empty());
+	uint8_t buf[REPORT_FRAME_MAX];
+	CHECK(frame.pack(buf, sizeof(buf)) == 0);
+}
+
+
+/// absolute count as difference, only after the gateway has acknowledged the reference
+static void testDelta()
+{
+	ReportFrame frame;
+	FrameContext context;
+	uint8_t buf[REPORT_FRAME_MAX];
+
+	frame.set(RF_ABS_COUNT, 659200);
+	uint8_t len = frame.pack(buf, sizeof(buf));
+	CHECK(buf[0] == REPORT_FRAME_VERSION);
+	frame.sent(false);								// not acknowledged, no reference yet
+	std::vector<DecodedValue> values;
+	CHECK(decodeFrame(buf, len, values, nullptr, &context));
+
+	frame.set(RF_ABS_COUNT, 659203);
+	auto v = roundTrip(frame, &context, REPORT_FRAME_MAX, &len);
+	CHECK(len == 2+3);
+	CHECK(v[RF_ABS_COUNT] == "659203");
+	frame.sent(true);
+
+	frame.set(RF_ABS_COUNT, 659210);
+	frame.set(RF_REL_COUNT, 7);
+	v = roundTrip(frame, &context, REPORT_FRAME_MAX, &len);
+	CHECK(len == 3+1+1);
+	CHECK(v[RF_REL_COUNT] == "7");
+	CHECK(v[RF_ABS_COUNT] == "659210");
+	frame.sent(true);
+
+	// new base count from the controller, lower than before
+	frame.set(RF_ABS_COUNT, 659150);
+	v = roundTrip(frame, &context, REPORT_FRAME_MAX, &len);
+	CHECK(len == 3+1);
+	CHECK(v[RF_ABS_COUNT] == "659150");
+	frame.sent(true);
+
+	// frame acknowledged by the gateway, but lost before the decoder
+	frame.set(RF_ABS_COUNT, 659160);
+	frame.pack(buf, sizeof(buf));
+	frame.sent(true);
+	frame.set(RF_ABS_COUNT, 659170);
+	frame.set(RF_VCC, 3012);
+	unsigned unresolved = context.unresolved;
+	v = roundTrip(frame, &context);
+	CHECK(context.unresolved == unresolved+1);
+	CHECK(v[RF_ABS_COUNT] == "");
+	CHECK(v[RF_VCC] == "3012");
+	frame.sent(true);
+
+	// at least every REPORT_FRAME_KEY frames, the count is sent in full
+	bool full = false;
+	for (uint32_t i=1; i<=REPORT_FRAME_KEY; i++) {
+		frame.set(RF_ABS_COUNT, 659170+i);
+		len = frame.pack(buf, sizeof(buf));
+		full = full || (buf[0] == REPORT_FRAME_VERSION);
+		values.clear();
+		CHECK(decodeFrame(buf, len, values, nullptr, &context));
+		frame.sent(true);
+	}
+	CHECK(full);
+	CHECK(context.valid && context.absCount == 659170+REPORT_FRAME_KEY);
+
+	// without a context, a difference can't be decoded at all
+	frame.set(RF_ABS_COUNT, 659190);
+	v = roundTrip(frame, nullptr);
+	CHECK(v[RF_ABS_COUNT] == "");
+}
+
+
+static void testErrors()
+{
+	std::vector<DecodedValue> values;
+	std::string error;
+	auto decode = [&]( std::vector<uint8_t> frame ) {
+		error.clear();
+		return decodeFrame(frame, values, &error);
+	};
+
+	CHECK(!decode({}) && error == "frame too short");
+	CHECK(!decode({ 0x01 }) && error == "frame too short");
+	CHECK(!decode({ 0x02, 0x02 }) && error == "frame too short");
+	CHECK(!decode({ 0x07, 0x00 }) && error == "unknown frame version");
+	CHECK(!decode({ 0x01, 0x03, 0x05 }) && error == "frame truncated");
+	CHECK(values.size() == 1);					// value before the error
+	CHECK(!decode({ 0x01, 0x01, 0x85 }) && error == "frame truncated");
+	CHECK(!decode({ 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 }) && error == "varint too long");
+	CHECK(!decode({ 0x01, 0x01, 0x05, 0x00 }) && error == "extra bytes after last field");
+	CHECK(decode({ 0x01, 0x00 }) && values.empty());
+
+	std::vector<uint8_t> bytes;
+	CHECK(parseHex("0103038AB428", bytes) && bytes.size() == 6 && bytes[3] == 0x8A);
+	CHECK(!parseHex("010", bytes));
+	CHECK(!parseHex("01G3", bytes));
+}
+
+
+int main()
+{
+	testAllFields();
+	testNegativeTemperature();
+	testOverflow();
+	testDelta();
+	testErrors();
+	if (failures) {
+		printf("%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file 		  gasframe.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Expand binary report frames from the gas meter node into one line 
+ * per value, with the topic the value would have had without PACKED_REPORT.
+ *
+ * Reads lines from stdin, e.g. from `mosquitto_sub -v -t 'my/+/stat/126/#'`
+ * or from the simulation, and copies them to stdout. A line whose topic 
+ * ends in `<sensor>/1/<ack>/48` followed by a hex payload is replaced by
+ *   my/2/stat/126/81/1/0/25 3
+ *   my/2/stat/126/81/1/0/24 659200
+ *   ...
+ * Alternatively, frames can be given as hex strings on the command line.
+ *
+ * The absolute count may be sent as difference to an earlier frame, so the
+ * frames of each node must be decoded in order, see ReportFrame.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "FrameDecoder.h"
+
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: gasframe [<hex frame> ...]\n"
+		"  without arguments, filter lines from stdin, e.g.\n"
+		"    mosquitto_sub -v -t 'my/+/stat/126/#' | gasframe\n"
+		"  and replace V_CUSTOM report frames with the values they carry\n");
+}
+
+
+static bool decodeHex( const std::string &hex, std::vector<DecodedValue> &values, 
+					   FrameContext &context )
+{
+	std::vector<uint8_t> bytes;
+	std::string error;
+	if (!parseHex(hex, bytes)) {
+		fprintf(stderr, "gasframe: '%s' is not a hex string\n", hex.c_str());
+		return false;
+	}
+	unsigned unresolved = context.unresolved;
+	if (!decodeFrame(bytes, values, &error, &context)) {
+		fprintf(stderr, "gasframe: %s: %s\n", hex.c_str(), error.c_str());
+		return false;
+	}
+	if (context.unresolved != unresolved)
+		fprintf(stderr, "gasframe: %s: absolute count difference without reference, dropped\n", hex.c_str());
+	return true;
+}
+
+
+int main( int argc, char *argv[] )
+{
+	if (argc > 1) {
+		if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+			usage();
+			return 0;
+		}
+		int rc = 0;
+		FrameContext context;
+		for (int i=1; i<argc; i++) {
+			std::vector<DecodedValue> values;
+			if (!decodeHex(argv[i], values, context)) { rc = 1; continue; }
+			for (const DecodedValue &v : values)
+				printf("%u/1/0/%u %s\n", v.sensor, v.type, v.payload.c_str());
+		}
+		return rc;
+	}
+
+	// prefix, sensor, ack, separator, payload
+	static const std::regex frameLine(
+		"^((?:.*[/\\s])?)(\\d+)/1/([01])/48(\\s+)([0-9A-Fa-f]+)\\s*$");
+	std::map<std::string, FrameContext> nodes;		// by topic prefix
+	std::string line;
+	while (std::getline(std::cin, line)) {
+		std::smatch m;
+		std::vector<DecodedValue> values;
+		if (!std::regex_match(line, m, frameLine)) {
+			std::cout << line << '\n';
+			continue;
+		}
+		// node topic, without anything before it, like a time stamp
+		std::string prefix = m[1].str();
+		std::string node = prefix.substr(prefix.find_last_of(" \t") + 1) + m[2].str();
+		if (!decodeHex(m[5], values, nodes[node])) {
+			std::cout << line << '\n';
+			continue;
+		}
+		for (const DecodedValue &v : values)
+			std::cout << m[1] << (unsigned)v.sensor << "/1/" << m[3] << '/' 
+				<< (unsigned)v.type << m[4] << v.payload << '\n';
+	}
+	return 0;
+}
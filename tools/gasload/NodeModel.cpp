@@ -0,0 +1,392 @@
+/**
+ * @file 		  NodeModel.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Model of one gas meter node, see NodeModel.h
+ *
+ * Only the messages are modelled, not the power management: the node
+ * publishes what MyGasMeterX.cpp with default options, or with 
+ * PACKED_REPORT or PULSE_JOURNAL, would send through the MQTT gateway, at 
+ * the same times. Like the firmware, it runs its tasks in wake periods 
+ * (Deadlines with TASK_SLACK), and only receives while it listens for a 
+ * base count, with the radio on and a wake every RX_POLL_INTERVAL.
+ * Not modelled: BACKFILL, which only sends when messages have failed, and 
+ * gasload's transport never fails; EXTRA_METERS, which would need traces 
+ * for the other meters; and the light and climate sensors.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "Debouncer.h"
+#include "NodeModel.h"
+
+// MySensors message types
+#define C_SET		1
+#define C_REQ		2
+#define C_INTERNAL	3
+#define I_BATTERY_LEVEL	0
+#define V_VAR1		24
+#define V_VAR2		25
+#define V_FLOW		34
+#define V_VOLUME	35
+#define V_VOLTAGE	38
+#define V_CUSTOM	48
+
+#define RX_FIFO		3		// nRF24 receive FIFO, messages beyond that are lost
+#define VCC_MV		3000	// battery voltage reported by every node
+
+static const uint64_t NEVER = UINT64_MAX;
+
+//===========================================================================
+
+/// Timer2 rate after `step` times POLL_QUIET_TIME without activity, see adaptRate()
+static uint32_t stepRate( uint8_t step )
+{
+	return std::max<uint32_t>(ISR_RATE >> step, POLL_MIN_RATE);
+}
+
+
+/**
+ * @brief Load trace with lines `[+]time_ms 0|1`, and find the pulses the 
+ * firmware would count: the contact is sampled as by myISR() and 
+ * adaptRate() in MyGasMeterX.cpp, and each closing that the debouncer 
+ * accepts is a pulse. The time of the last line is the period.
+ */
+bool PulseTrace::load( const char *path )
+{
+	FILE *f = fopen(path, "r");
+	if (!f) { perror(path); return false; }
+
+	char line[128];
+	unsigned lineno = 0;
+	uint64_t tPrev = 0;
+	std::vector<std::pair<uint64_t,bool>> edges;
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		char *p = line + strspn(line, " \t");
+		if (*p=='#' || *p=='\n' || *p=='\r' || *p==0) continue;
+		bool relative = (*p=='+');
+		if (relative) p++;
+		char *end;
+		uint64_t ms = strtoull(p, &end, 10);
+		int state = (int)strtol(end, &end, 10);
+		if (end == p || (state != 0 && state != 1)) {
+			fprintf(stderr, "%s:%u: expected '[+]time_ms 0|1'\n", path, lineno);
+			fclose(f);
+			return false;
+		}
+		if (relative) ms += tPrev;
+		if (ms < tPrev) {
+			fprintf(stderr, "%s:%u: time goes backwards\n", path, lineno);
+			fclose(f);
+			return false;
+		}
+		tPrev = ms;
+		edges.push_back(std::make_pair(ms, state==1));
+	}
+	fclose(f);
+	_period = tPrev;
+	if (_period == 0) {
+		fprintf(stderr, "%s: empty trace\n", path);
+		return false;
+	}
+
+	Debouncer contacts;
+	uint8_t step = 0;					// index into the rate steps
+	uint64_t tActive = 0;				// last time the contact was closed
+	bool closed = false;
+	size_t e = 0;
+	_pulses.clear();
+	for (uint64_t t = 0; t < _period; t += 1000 / stepRate(step)) {
+		while (e < edges.size() && edges[e].first <= t)
+			closed = edges[e++].second;
+		if (contacts.tick(closed) & contacts.state)
+			_pulses.push_back(t);
+		if (closed || contacts.state) {
+			tActive = t;
+			step = 0;
+		} else if (stepRate(step) > POLL_MIN_RATE && t - tActive >= (step+1) * (uint64_t)POLL_QUIET_TIME) {
+			step++;
+		}
+	}
+	return true;
+}
+
+
+void PulseTrace::constant( uint32_t interval )
+{
+	_pulses.assign(1, 0);
+	_period = interval;
+}
+
+
+uint64_t PulseTrace::next( uint64_t t ) const
+{
+	if (_pulses.empty()) return NEVER;
+	uint64_t base = t - t % _period;
+	auto it = std::lower_bound(_pulses.begin(), _pulses.end(), t - base);
+	if (it == _pulses.end()) return base + _period + _pulses.front();
+	return base + *it;
+}
+
+//===========================================================================
+
+NodeModel::NodeModel( uint8_t id, const PulseTrace &trace, uint64_t phase, 
+					  Transport &transport, const std::string &pubPrefix,
+					  const NodeOptions &options )
+	: _id(id), _trace(trace), _phase(phase), _transport(transport), 
+	  _prefix(pubPrefix + "/" + std::to_string(id)), _options(options),
+	  _chCount(defaultCountPolicy), _chVCC(vccPolicy),
+	  _absValid(false), _awaitConfirm(false), 
+	  _absPulseCount(0), _pulseCount(0), _countPerHour(0),
+	  _tStart(0), _tNow(0), _tPulse(NEVER), _tCount(NEVER), _tFlow(NEVER), _tBattery(NEVER),
+	  _tPoll(NEVER), _tBase(NEVER), _requests(0), _lost(0), _published(0)
+{
+}
+
+
+/**
+ * @brief Power-on: send what setup() sends, and ask controller for the 
+ * base count. With PULSE_JOURNAL, the node starts with the count from
+ * EEPROM (0 here), and listens for a correction for CONFIRM_TIME.
+ */
+void NodeModel::start( uint64_t now )
+{
+	_tStart = _tNow = now;
+	if (_options.journal) {
+		_absValid = true;
+		_awaitConfirm = true;
+	}
+	taskBattery(now);
+	send(SENSOR_ID_GAS, C_REQ, V_VAR1, "");
+	_requests++;
+	send(SENSOR_ID_GAS, V_VAR1, _absValid ? _absPulseCount : 0);
+	_tPulse = _trace.next(now + _phase) - _phase;
+	_tFlow = now + 1 HOURS;
+	_tCount = now + defaultCountPolicy.maxSilence;
+	_tBattery = now + BATTERY_REPORT_INTERVAL;
+	sendFrame();
+	_tPoll = listening() ? now + RX_POLL_INTERVAL : NEVER;
+}
+
+
+uint64_t NodeModel::next() const
+{
+	return std::min(std::min(std::min(_tPulse, _tCount), std::min(_tFlow, _tBattery)), _tPoll);
+}
+
+
+/**
+ * @brief Handle all events due at or before `now`, in order.
+ */
+void NodeModel::run( uint64_t now )
+{
+	for (;;) {
+		uint64_t t = next();
+		if (t > now) return;
+		wake(t);
+	}
+}
+
+
+/**
+ * @brief One wake period, as loop(): messages received by MySensors before
+ * loop() is called, new pulses, then the tasks that are due, plus those 
+ * due within TASK_SLACK, except the count report, which never runs early.
+ */
+void NodeModel::wake( uint64_t t )
+{
+	_tNow = t;
+	takeMessages(t);
+	if (t == _tPulse) {
+		_pulseCount++;
+		_tPulse = _trace.next(t + 1 + _phase) - _phase;
+		_tCount = std::min(_tCount, _tStart + _chCount.earliest((uint32_t)(t - _tStart)));
+	}
+	if (_tCount <= t || _tFlow <= t || _tBattery <= t) {
+		uint64_t soon = t + TASK_SLACK;
+		if (_tCount <= t) taskCount(_tCount);
+		if (_tFlow <= soon) taskFlow(_tFlow);
+		if (_tBattery <= soon) taskBattery(_tBattery);
+	}
+	sendFrame();
+	if (_awaitConfirm && t - _tStart >= CONFIRM_TIME)
+		_awaitConfirm = false;
+	_tPoll = listening() ? t + RX_POLL_INTERVAL : NEVER;
+}
+
+
+/**
+ * @brief Base counts in the RX FIFO, handled as receive() in MyGasMeterX.cpp
+ */
+void NodeModel::takeMessages( uint64_t t )
+{
+	for (const std::string &payload : _rx) {
+		_absPulseCount = atol(payload.c_str());
+		_absValid = true;
+		_awaitConfirm = false;
+		if (_tBase == NEVER) _tBase = t - _tStart;
+		send(SENSOR_ID_GAS, V_VAR1, _absPulseCount + _pulseCount);
+	}
+	_rx.clear();
+}
+
+
+/**
+ * @brief as countGas() in MyGasMeterX.cpp
+ */
+void NodeModel::taskCount( uint64_t due )
+{
+	uint32_t rel = (uint32_t)(due - _tStart);
+	if (!_chCount.check(_pulseCount, rel)) {
+		if (_chCount.changed(_pulseCount))
+			_tCount = _tStart + _chCount.earliest(rel);
+		else
+			_tCount = _tStart + _chCount.heartbeat();
+		return;
+	}
+	uint32_t count = _pulseCount;
+	if (_absValid) {
+		_pulseCount = 0;
+		_absPulseCount += count;
+		report(RF_REL_COUNT, count);
+		report(RF_ABS_COUNT, _absPulseCount);
+	} else {
+		report(RF_REL_COUNT, count);
+		send(SENSOR_ID_GAS, C_REQ, V_VAR1, "");
+		_requests++;
+	}
+	_chCount.sent(count, rel);
+	_countPerHour += count;
+	if (count != 0)
+		_tCount = _tStart + _chCount.earliest(rel);
+	else
+		_tCount = _tStart + _chCount.heartbeat();
+}
+
+
+/**
+ * @brief as taskFlow() in MyGasMeterX.cpp
+ */
+void NodeModel::taskFlow( uint64_t due )
+{
+	uint32_t liters = _countPerHour * LITERS_PER_CLICK;
+	report(RF_FLOW, liters);
+	if (_absValid)
+		report(RF_VOLUME, _absPulseCount * LITERS_PER_CLICK);
+	_countPerHour = 0;
+	_tFlow = due + 1 HOURS;
+}
+
+
+/**
+ * @brief as taskBattery() and reportBatteryVoltage() in MyGasMeterX.cpp,
+ * with a constant voltage
+ */
+void NodeModel::taskBattery( uint64_t due )
+{
+	uint32_t rel = (uint32_t)(due - _tStart);
+	if (_chVCC.check(VCC_MV, rel)) {
+		report(RF_VCC, VCC_MV);
+		send(255, C_INTERNAL, I_BATTERY_LEVEL, "100");
+		_chVCC.sent(VCC_MV, rel);
+	}
+	_tBattery = due + BATTERY_REPORT_INTERVAL;
+}
+
+
+/**
+ * @brief Message from controller, V_VAR1 carries the base count. Like the
+ * firmware, the node only receives while it listens, i.e. until it has a 
+ * base count, or for CONFIRM_TIME after restoring one from EEPROM. The 
+ * message waits in the RX FIFO until the next wake period.
+ *
+ * @return true if the message was received
+ */
+bool NodeModel::receive( int type, const std::string &payload )
+{
+	if (type != V_VAR1) return false;
+	if (!listening() || _rx.size() >= RX_FIFO) {
+		_lost++;
+		return false;
+	}
+	_rx.push_back(payload);
+	return true;
+}
+
+
+/**
+ * @brief report one value, as a message of its own, or into the frame
+ */
+void NodeModel::report( ReportField field, uint32_t value )
+{
+	if (_options.packed) {
+		_frame.set(field, value);
+		return;
+	}
+	const ReportTopic &topic = reportTopics[field];
+	send(topic.sensor, topic.type, (int32_t)value);
+}
+
+
+/**
+ * @brief as sendFrame() in MyGasMeterX.cpp, the gateway publishes the 
+ * frame in hex
+ */
+void NodeModel::sendFrame()
+{
+	uint8_t buf[REPORT_FRAME_MAX];
+	uint8_t len;
+	while ((len = _frame.pack(buf, sizeof(buf))) != 0) {
+		static const char hex[] = "0123456789ABCDEF";
+		std::string payload;
+		for (uint8_t i=0; i<len; i++) {
+			payload += hex[buf[i] >> 4];
+			payload += hex[buf[i] & 0x0F];
+		}
+		send(SENSOR_ID_GAS, C_SET, V_CUSTOM, payload);
+		_frame.sent(true);
+	}
+}
+
+
+void NodeModel::send( int sensor, int command, int type, const std::string &payload )
+{
+	char topic[64];
+	snprintf(topic, sizeof(topic), "/%d/%d/0/%d", sensor, command, type);
+	_transport.publish(_prefix + topic, payload);
+	_published++;
+	if (_options.log) {
+		uint64_t t = _tNow - _tStart;
+		fprintf(_options.log, "%u %llu.%03u %s %s\n", _id, (unsigned long long)(t / 1000), 
+			(unsigned)(t % 1000), (_prefix + topic).c_str(), payload.c_str());
+	}
+}
+
+
+void NodeModel::send( int sensor, int type, int32_t value )
+{
+	send(sensor, C_SET, type, std::to_string(value));
+}
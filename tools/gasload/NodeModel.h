@@ -0,0 +1,140 @@
+/**
+ * @file 		  NodeModel.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief One simulated gas meter node for gasload: the reporting done by
+ * loop() and the base count handshake done by receive() in MyGasMeterX.cpp,
+ * driven by a reed switch trace instead of the hardware. IDs, policies and
+ * timing come from src/NodeDefs.h, as for the firmware.
+ * This is a model of the default build, re-implemented on the host: the
+ * options in NodeOptions are the only ones modelled, see the README for
+ * what is left out. `make check` compares it with the simulated firmware.
+ */
+
+#ifndef _NODEMODEL_H
+#define _NODEMODEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "NodeDefs.h"
+#include "ReportPolicy.h"
+#include "ReportFrame.h"
+#include "Transport.h"
+
+/**
+ * @brief Pulse times from a reed switch trace in the format used by the 
+ * simulation (see sim/traces), debounced like the firmware does: sampled 
+ * at the Timer2 rate, which drops from ISR_RATE to POLL_MIN_RATE while the 
+ * meter is idle, with the Debouncer from src/Debouncer.h.
+ */
+class PulseTrace
+{
+	public:
+		PulseTrace() : _period(0) {}
+		bool load( const char *path );
+		/// one pulse every `interval` ms, if there is no trace file
+		void constant( uint32_t interval );
+		/// period of the trace in ms, the trace repeats after that
+		uint64_t period() const { return _period; }
+		size_t size() const { return _pulses.size(); }
+		/// time of the first pulse at or after t, with the trace repeated
+		uint64_t next( uint64_t t ) const;
+
+	private:
+		std::vector<uint64_t> _pulses;	// times in ms within one period
+		uint64_t _period;
+};
+
+
+/// firmware options that change what a node sends
+struct NodeOptions
+{
+	bool packed = false;		///< PACKED_REPORT, values as V_CUSTOM frames
+	bool journal = false;		///< PULSE_JOURNAL, nodes restart with a count from EEPROM
+	FILE *log = nullptr;		///< print every message with node time
+};
+
+
+class NodeModel
+{
+	public:
+		NodeModel( uint8_t id, const PulseTrace &trace, uint64_t phase, 
+				   Transport &transport, const std::string &pubPrefix,
+				   const NodeOptions &options );
+
+		void start( uint64_t now );
+		/// time of next event, in ms since the node was started
+		uint64_t next() const;
+		void run( uint64_t now );
+		bool receive( int type, const std::string &payload );
+
+		uint8_t id() const { return _id; }
+		bool absValid() const { return _absValid; }
+		/// node time when the first base count was taken, or UINT64_MAX
+		uint64_t tBase() const { return _tBase; }
+		uint32_t requests() const { return _requests; }
+		uint32_t lost() const { return _lost; }
+		uint64_t published() const { return _published; }
+
+	private:
+		bool listening() const { return !_absValid || _awaitConfirm; }
+		void wake( uint64_t t );
+		void takeMessages( uint64_t t );
+		void taskCount( uint64_t due );
+		void taskFlow( uint64_t due );
+		void taskBattery( uint64_t due );
+		void report( ReportField field, uint32_t value );
+		void sendFrame();
+		void send( int sensor, int command, int type, const std::string &payload );
+		void send( int sensor, int type, int32_t value );
+
+		uint8_t _id;
+		const PulseTrace &_trace;
+		uint64_t _phase;			// offset into trace, so nodes don't pulse in lockstep
+		Transport &_transport;
+		std::string _prefix;		// e.g. "my/1/stat/126"
+		NodeOptions _options;
+
+		ReportChannel _chCount;
+		ReportChannel _chVCC;
+		ReportFrame _frame;
+		bool _absValid;
+		bool _awaitConfirm;			// count restored from EEPROM, listening for controller
+		std::vector<std::string> _rx;	// base counts in the radio's RX FIFO
+		int32_t _absPulseCount;
+		uint32_t _pulseCount;		// pulses since last report
+		uint32_t _countPerHour;
+		uint64_t _tStart;
+		uint64_t _tNow;				// time of current wake period
+		uint64_t _tPulse;			// next pulse
+		uint64_t _tCount;			// next count report, or UINT64_MAX
+		uint64_t _tFlow;			// end of current hour
+		uint64_t _tBattery;			// next battery measurement
+		uint64_t _tPoll;			// next wake to receive, while listening
+		uint64_t _tBase;			// first base count taken
+		uint32_t _requests;			// V_VAR1 requests sent
+		uint32_t _lost;				// base counts sent while the radio was off, or FIFO full
+		uint64_t _published;		// messages published
+};
+
+#endif // _NODEMODEL_H
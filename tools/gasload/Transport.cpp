@@ -0,0 +1,315 @@
+/**
+ * @file 		  Transport.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief MQTT client and loopback stand-in for gasload, see Transport.h
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "Transport.h"
+
+// MQTT control packet types, in the upper nibble of the fixed header
+#define MQTT_CONNECT	0x10
+#define MQTT_CONNACK	0x20
+#define MQTT_PUBLISH	0x30
+#define MQTT_SUBSCRIBE	0x82		// with required flags
+#define MQTT_SUBACK		0x90
+#define MQTT_PINGREQ	0xC0
+#define MQTT_PINGRESP	0xD0
+
+
+/// monotonic time in ms
+uint64_t millisNow()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000u + ts.tv_nsec / 1000000u;
+}
+
+
+static uint64_t microsNow()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000u;
+}
+
+
+static void putString( std::string &s, const std::string &str )
+{
+	s += (char)(str.size() >> 8);
+	s += (char)(str.size() & 0xFF);
+	s += str;
+}
+
+//===========================================================================
+
+MqttTransport::~MqttTransport()
+{
+	if (_fd >= 0) {
+		sendPacket(0xE0, "");		// DISCONNECT
+		close(_fd);
+	}
+}
+
+
+/**
+ * @brief Open TCP connection to broker, and send CONNECT with clean session.
+ */
+bool MqttTransport::connect( const std::string &host, uint16_t port, const std::string &clientId )
+{
+	struct addrinfo hints, *res;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	char service[8];
+	snprintf(service, sizeof(service), "%u", port);
+	int rc = getaddrinfo(host.c_str(), service, &hints, &res);
+	if (rc != 0) {
+		fprintf(stderr, "gasload: %s: %s\n", host.c_str(), gai_strerror(rc));
+		return false;
+	}
+	for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+		_fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (_fd < 0) continue;
+		if (::connect(_fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+		close(_fd);
+		_fd = -1;
+	}
+	freeaddrinfo(res);
+	if (_fd < 0) {
+		fprintf(stderr, "gasload: can't connect to %s:%u\n", host.c_str(), port);
+		return false;
+	}
+	int one = 1;
+	setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	std::string body;
+	putString(body, "MQTT");
+	body += (char)4;						// protocol level 3.1.1
+	body += (char)0x02;						// clean session
+	body += (char)(_keepAlive >> 8);
+	body += (char)(_keepAlive & 0xFF);
+	putString(body, clientId);
+	if (!sendPacket(MQTT_CONNECT, body)) return false;
+
+	uint8_t header;
+	if (!readPacket(header, body, 5000) || (header & 0xF0) != MQTT_CONNACK 
+		|| body.size() < 2 || body[1] != 0) {
+		fprintf(stderr, "gasload: broker refused connection\n");
+		return false;
+	}
+	return true;
+}
+
+
+bool MqttTransport::subscribe( const std::string &filter )
+{
+	std::string body;
+	body += (char)(_packetId >> 8);
+	body += (char)(_packetId & 0xFF);
+	_packetId++;
+	putString(body, filter);
+	body += (char)0;						// QoS 0
+	return sendPacket(MQTT_SUBSCRIBE, body);
+}
+
+
+bool MqttTransport::publish( const std::string &topic, const std::string &payload )
+{
+	std::string body;
+	putString(body, topic);
+	body += payload;
+	return sendPacket(MQTT_PUBLISH, body);
+}
+
+
+/**
+ * @brief Receive and dispatch messages for up to timeoutMs, send PINGREQ
+ * as needed.
+ */
+bool MqttTransport::poll( int timeoutMs, const MessageHandler &handler )
+{
+	uint64_t tEnd = millisNow() + timeoutMs;
+	for (;;) {
+		uint64_t t = millisNow();
+		if (t - _lastSent >= _keepAlive * 500u && !sendPacket(MQTT_PINGREQ, "")) 
+			return false;
+		int wait = (t < tEnd) ? (int)(tEnd - t) : 0;
+		uint8_t header;
+		std::string body;
+		if (!readPacket(header, body, wait)) return _fd >= 0;
+		if ((header & 0xF0) == MQTT_PUBLISH && body.size() >= 2) {
+			size_t len = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+			size_t skip = 2 + len + ((header & 0x06) ? 2 : 0);	// packet id if QoS>0
+			if (skip <= body.size())
+				handler(body.substr(2, len), body.substr(skip));
+		}
+		// after tEnd, drain whatever has arrived already, but don't block
+	}
+}
+
+
+bool MqttTransport::sendPacket( uint8_t header, const std::string &body )
+{
+	std::string pkt;
+	pkt += (char)header;
+	size_t len = body.size();
+	do {
+		uint8_t b = len & 0x7F;
+		len >>= 7;
+		if (len) b |= 0x80;
+		pkt += (char)b;
+	} while (len);
+	pkt += body;
+
+	const char *p = pkt.data();
+	size_t n = pkt.size();
+	while (n) {
+		ssize_t w = send(_fd, p, n, MSG_NOSIGNAL);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			perror("gasload: send");
+			close(_fd);
+			_fd = -1;
+			return false;
+		}
+		p += w;
+		n -= w;
+	}
+	_lastSent = millisNow();
+	return true;
+}
+
+
+bool MqttTransport::readFully( void *buf, size_t len )
+{
+	uint8_t *p = (uint8_t*)buf;
+	while (len) {
+		ssize_t r = recv(_fd, p, len, 0);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) {
+			fprintf(stderr, "gasload: connection to broker lost\n");
+			close(_fd);
+			_fd = -1;
+			return false;
+		}
+		p += r;
+		len -= r;
+	}
+	return true;
+}
+
+
+/**
+ * @brief Read one packet, if one starts arriving within timeoutMs.
+ */
+bool MqttTransport::readPacket( uint8_t &header, std::string &body, int timeoutMs )
+{
+	if (_fd < 0) return false;
+	struct pollfd pfd = { _fd, POLLIN, 0 };
+	if (::poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+	if (!readFully(&header, 1)) return false;
+	size_t len = 0;
+	for (int shift=0; shift<28; shift+=7) {
+		uint8_t b;
+		if (!readFully(&b, 1)) return false;
+		len |= (size_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) break;
+	}
+	body.resize(len);
+	return len == 0 || readFully(&body[0], len);
+}
+
+//===========================================================================
+
+/**
+ * @param cmdPrefix 	topic prefix for messages to nodes, e.g. "my/cmnd"
+ * @param base 			base count in the reply to V_VAR1 requests
+ * @param delayMs 		time from request to reply, in ms
+ * @param rate 			max. messages per second the controller processes, 0 = no limit
+ */
+LoopbackTransport::LoopbackTransport( const std::string &cmdPrefix, int64_t base, 
+									  uint32_t delayMs, uint32_t rate )
+	: _cmdPrefix(cmdPrefix), _base(base), _delay(delayMs), _rate(rate), _busyUntil(0)
+{
+}
+
+
+bool LoopbackTransport::subscribe( const std::string & )
+{
+	return true;
+}
+
+
+/**
+ * @brief The controller sees every message, and answers requests 
+ * `<prefix>/<node>/81/2/0/24` on `<cmdPrefix>/<node>/81/1/0/24`.
+ */
+bool LoopbackTransport::publish( const std::string &topic, const std::string & )
+{
+	uint64_t t = microsNow();
+	if (_rate) {
+		// messages queue up at the controller
+		if (_busyUntil < t) _busyUntil = t;
+		_busyUntil += 1000000u / _rate;
+		t = _busyUntil;
+	}
+	static const std::string request = "/81/2/0/24";
+	if (topic.size() > request.size() 
+		&& topic.compare(topic.size() - request.size(), request.size(), request) == 0) {
+		size_t end = topic.size() - request.size();
+		size_t start = topic.rfind('/', end - 1) + 1;
+		std::string node = topic.substr(start, end - start);
+		_replies.push_back(Reply{ t / 1000u + _delay, 
+			_cmdPrefix + "/" + node + "/81/1/0/24", std::to_string(_base) });
+	}
+	return true;
+}
+
+
+bool LoopbackTransport::poll( int timeoutMs, const MessageHandler &handler )
+{
+	uint64_t tEnd = millisNow() + timeoutMs;
+	for (;;) {
+		uint64_t t = millisNow();
+		while (!_replies.empty() && _replies.front().due <= t) {
+			Reply r = _replies.front();
+			_replies.pop_front();
+			handler(r.topic, r.payload);
+		}
+		if (t >= tEnd) return true;
+		uint64_t tNext = _replies.empty() ? tEnd : std::min(tEnd, _replies.front().due);
+		if (tNext > t) usleep((tNext - t) * 1000u);
+	}
+}
+
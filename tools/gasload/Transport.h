@@ -0,0 +1,103 @@
+/**
+ * @file 		  Transport.h
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief How gasload talks to the MySensors MQTT gateway's side of the 
+ * world: either a real MQTT broker, or an in-process stand-in for the broker
+ * and the controller.
+ */
+
+#ifndef _TRANSPORT_H
+#define _TRANSPORT_H
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <string>
+
+/// called for every message received, with full topic and payload
+typedef std::function<void(const std::string &topic, const std::string &payload)> MessageHandler;
+
+class Transport
+{
+	public:
+		virtual ~Transport() {}
+		virtual bool subscribe( const std::string &filter ) = 0;
+		virtual bool publish( const std::string &topic, const std::string &payload ) = 0;
+		/// wait up to timeoutMs for messages, call handler for each one
+		virtual bool poll( int timeoutMs, const MessageHandler &handler ) = 0;
+};
+
+
+/**
+ * @brief Minimal MQTT 3.1.1 client, QoS 0 only, over a blocking TCP socket.
+ */
+class MqttTransport : public Transport
+{
+	public:
+		MqttTransport() : _fd(-1), _lastSent(0), _keepAlive(60) {}
+		~MqttTransport();
+
+		bool connect( const std::string &host, uint16_t port, const std::string &clientId );
+		bool subscribe( const std::string &filter ) override;
+		bool publish( const std::string &topic, const std::string &payload ) override;
+		bool poll( int timeoutMs, const MessageHandler &handler ) override;
+
+	private:
+		bool sendPacket( uint8_t header, const std::string &body );
+		bool readPacket( uint8_t &header, std::string &body, int timeoutMs );
+		bool readFully( void *buf, size_t len );
+
+		int _fd;
+		uint64_t _lastSent;			// time of last packet sent, in ms
+		uint16_t _keepAlive;		// in s
+		uint16_t _packetId = 1;
+};
+
+
+/**
+ * @brief Stand-in for broker and controller: answers V_VAR1 requests with
+ * a base count after a delay, processing at most `rate` messages per second, 
+ * like a controller with a rule for each node.
+ */
+class LoopbackTransport : public Transport
+{
+	public:
+		LoopbackTransport( const std::string &cmdPrefix, int64_t base, 
+						   uint32_t delayMs, uint32_t rate );
+
+		bool subscribe( const std::string &filter ) override;
+		bool publish( const std::string &topic, const std::string &payload ) override;
+		bool poll( int timeoutMs, const MessageHandler &handler ) override;
+
+	private:
+		struct Reply { uint64_t due; std::string topic, payload; };
+
+		std::string _cmdPrefix;
+		int64_t _base;
+		uint32_t _delay;
+		uint32_t _rate;
+		uint64_t _busyUntil;		// controller works off its queue until then, in us
+		std::deque<Reply> _replies;
+};
+
+uint64_t millisNow();
+
+#endif // _TRANSPORT_H
@@ -0,0 +1,291 @@
+/**
+ * @file 		  gasload.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Traffic generator for load-testing the gateway / broker / controller
+ * pipeline with many gas meter nodes.
+ *
+ * Runs one NodeModel per simulated node, each replaying the same reed switch
+ * trace with a random phase, and publishes what the node would send via the
+ * MySensors MQTT gateway, e.g.
+ *   my/1/stat/17/81/1/0/25 3
+ * Base counts are expected on `<cmd prefix>/<node>/81/1/0/24`. Prints message
+ * rates while running, and at the end how long it took the nodes to get
+ * their base count. E.g.
+ *
+ *     ./gasload --nodes 100 --trace ../../sim/traces/winter_day.txt --speed 60
+ *     ./gasload --loopback --nodes 200 --controller-rate 50
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "NodeDefs.h"
+#include "NodeModel.h"
+#include "Transport.h"
+
+#define V_VAR1			24
+
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: gasload [options]\n"
+		"  --host H            MQTT broker (default localhost)\n"
+		"  --port P            MQTT port (default 1883)\n"
+		"  --loopback          no broker, built-in controller answers requests\n"
+		"  --nodes N           number of nodes (default 10)\n"
+		"  --first-id ID       node ID of first node (default 1)\n"
+		"  --trace FILE        reed switch trace, lines of '[+]time_ms 0|1', repeated\n"
+		"  --interval MS       without trace, one pulse every MS (default 18000)\n"
+		"  --speed X           run node time X times faster than real time (default 1)\n"
+		"  --spread MS         power up nodes within MS of real time (default 1000)\n"
+		"  --duration S        stop after S seconds of real time (default 60)\n"
+		"  --stats S           print rates every S seconds (default 5)\n"
+		"  --pub-prefix P      topic prefix for node messages (default my/1/stat)\n"
+		"  --cmd-prefix P      topic prefix for messages to nodes (default my/cmnd)\n"
+		"  --answer N          answer V_VAR1 requests with N, like a controller\n"
+		"  --reply-delay MS    loopback controller reply delay (default 200)\n"
+		"  --controller-rate R loopback controller handles max. R messages/s (default no limit)\n"
+		"  --phase MS          all nodes start at MS into the trace (default random)\n"
+		"  --packed            nodes built with PACKED_REPORT\n"
+		"  --journal           nodes built with PULSE_JOURNAL, restarting with a count\n"
+		"  --log FILE          print every message with node ID and node time\n"
+		"  --seed N            seed for random phases\n");
+	exit(1);
+}
+
+
+/// percentile p (0..100) of sorted values
+static uint64_t percentile( const std::vector<uint64_t> &v, unsigned p )
+{
+	if (v.empty()) return 0;
+	return v[std::min(v.size()-1, (v.size() * p) / 100)];
+}
+
+
+int main( int argc, char *argv[] )
+{
+	const char *host = "localhost";
+	unsigned port = 1883;
+	bool loopback = false;
+	unsigned nodes = 10;
+	unsigned firstId = 1;
+	const char *tracePath = NULL;
+	uint32_t interval = 18000;
+	double speed = 1;
+	uint32_t spread = 1000;
+	double duration = 60;
+	double statsInterval = 5;
+	std::string pubPrefix = "my/1/stat";
+	std::string cmdPrefix = "my/cmnd";
+	int64_t answer = -1;
+	int64_t base = 0;
+	uint32_t replyDelay = 200;
+	uint32_t controllerRate = 0;
+	unsigned seed = 1;
+	NodeOptions options;
+	const char *logPath = NULL;
+	int64_t phase = -1;
+
+	for (int i=1; i<argc; i++) {
+		const char *a = argv[i];
+		bool hasArg = (i+1 < argc);
+		if (!strcmp(a,"--host") && hasArg)						host = argv[++i];
+		else if (!strcmp(a,"--port") && hasArg)					port = (unsigned)atoi(argv[++i]);
+		else if (!strcmp(a,"--loopback"))						loopback = true;
+		else if (!strcmp(a,"--nodes") && hasArg)				nodes = (unsigned)atoi(argv[++i]);
+		else if (!strcmp(a,"--first-id") && hasArg)				firstId = (unsigned)atoi(argv[++i]);
+		else if (!strcmp(a,"--trace") && hasArg)				tracePath = argv[++i];
+		else if (!strcmp(a,"--interval") && hasArg)				interval = (uint32_t)atol(argv[++i]);
+		else if (!strcmp(a,"--speed") && hasArg)				speed = atof(argv[++i]);
+		else if (!strcmp(a,"--spread") && hasArg)				spread = (uint32_t)atol(argv[++i]);
+		else if (!strcmp(a,"--duration") && hasArg)				duration = atof(argv[++i]);
+		else if (!strcmp(a,"--stats") && hasArg)				statsInterval = atof(argv[++i]);
+		else if (!strcmp(a,"--pub-prefix") && hasArg)			pubPrefix = argv[++i];
+		else if (!strcmp(a,"--cmd-prefix") && hasArg)			cmdPrefix = argv[++i];
+		else if (!strcmp(a,"--answer") && hasArg)				answer = base = atoll(argv[++i]);
+		else if (!strcmp(a,"--reply-delay") && hasArg)			replyDelay = (uint32_t)atol(argv[++i]);
+		else if (!strcmp(a,"--controller-rate") && hasArg)		controllerRate = (uint32_t)atol(argv[++i]);
+		else if (!strcmp(a,"--phase") && hasArg)				phase = atoll(argv[++i]);
+		else if (!strcmp(a,"--packed"))							options.packed = true;
+		else if (!strcmp(a,"--journal"))						options.journal = true;
+		else if (!strcmp(a,"--log") && hasArg)					logPath = argv[++i];
+		else if (!strcmp(a,"--seed") && hasArg)					seed = (unsigned)atoi(argv[++i]);
+		else usage();
+	}
+	// MySensors node IDs are 1...254
+	if (nodes < 1 || firstId < 1 || firstId + nodes - 1 > 254) {
+		fprintf(stderr, "gasload: node IDs must be in 1...254\n");
+		return 1;
+	}
+	if (speed <= 0 || interval == 0) usage();
+
+	if (logPath && !(options.log = fopen(logPath, "w"))) {
+		perror(logPath);
+		return 1;
+	}
+
+	PulseTrace trace;
+	if (tracePath) {
+		if (!trace.load(tracePath)) return 1;
+	} else {
+		trace.constant(interval);
+	}
+
+	std::unique_ptr<Transport> transport;
+	if (loopback) {
+		transport.reset(new LoopbackTransport(cmdPrefix, base, replyDelay, controllerRate));
+	} else {
+		MqttTransport *mqtt = new MqttTransport;
+		transport.reset(mqtt);
+		if (!mqtt->connect(host, (uint16_t)port, "gasload-" + std::to_string(getpid()))) 
+			return 1;
+	}
+	const std::string gas = "/" + std::to_string(SENSOR_ID_GAS) + "/";
+	transport->subscribe(cmdPrefix + "/+" + gas + "1/0/24");
+	if (answer >= 0 && !loopback)
+		transport->subscribe(pubPrefix + "/+" + gas + "2/0/24");
+
+	// nodes power up at random times, and are at random points in the trace
+	std::mt19937_64 rng(seed);
+	std::vector<NodeModel> models;
+	std::vector<uint64_t> tPowerUp(nodes);			// real time, in ms since t0
+	std::vector<uint64_t> latencies;				// real time to base count, in ms
+	models.reserve(nodes);
+	for (unsigned i=0; i<nodes; i++) {
+		uint64_t offset = rng() % trace.period();
+		if (phase >= 0) offset = (uint64_t)phase % trace.period();
+		models.emplace_back((uint8_t)(firstId + i), trace, offset, 
+							*transport, pubPrefix, options);
+		tPowerUp[i] = spread ? rng() % spread : 0;
+	}
+	std::vector<bool> started(nodes, false);
+	std::vector<bool> based(nodes, false);			// latency recorded
+
+	uint64_t t0 = millisNow();
+	uint64_t received = 0, receivedLast = 0, publishedLast = 0;
+	double peakRate = 0;
+	uint64_t tStats = (uint64_t)(statsInterval * 1000);
+	uint64_t tEnd = (uint64_t)(duration * 1000);
+
+	auto published = [&]() {
+		uint64_t n = 0;
+		for (const NodeModel &m : models) n += m.published();
+		return n;
+	};
+
+	MessageHandler onMessage = [&]( const std::string &topic, const std::string &payload ) {
+		received++;
+		// <prefix>/<node>/<sensor>/<command>/<ack>/<type>
+		size_t end = topic.rfind(gas);
+		if (end == std::string::npos || end == 0) return;
+		size_t start = topic.rfind('/', end - 1) + 1;
+		unsigned id = (unsigned)atoi(topic.c_str() + start);
+		const char *rest = topic.c_str() + end + gas.size();
+		if (!strcmp(rest, "2/0/24") && answer >= 0) {
+			if (!topic.compare(0, pubPrefix.size() + 1, pubPrefix + "/"))
+				transport->publish(cmdPrefix + "/" + std::to_string(id) + "/81/1/0/24", 
+								   std::to_string(answer));
+			return;
+		}
+		if (strcmp(rest, "1/0/24") || id < firstId || id >= firstId + nodes) return;
+		unsigned i = id - firstId;
+		if (started[i]) models[i].receive(V_VAR1, payload);
+	};
+
+	for (;;) {
+		uint64_t t = millisNow() - t0;
+		if (t >= tEnd) break;
+
+		// node time runs `speed` times faster, from power-up of each node
+		uint64_t tNext = tEnd;
+		for (unsigned i=0; i<nodes; i++) {
+			if (t < tPowerUp[i]) {
+				tNext = std::min(tNext, tPowerUp[i]);
+				continue;
+			}
+			uint64_t now = (uint64_t)((t - tPowerUp[i]) * speed);
+			if (!started[i]) {
+				models[i].start(0);
+				started[i] = true;
+			}
+			models[i].run(now);
+			if (!based[i] && models[i].tBase() != UINT64_MAX) {
+				based[i] = true;
+				latencies.push_back((uint64_t)(models[i].tBase() / speed));
+			}
+			tNext = std::min(tNext, tPowerUp[i] + (uint64_t)(models[i].next() / speed) + 1);
+		}
+
+		if (t >= tStats) {
+			uint64_t pub = published();
+			double rate = (pub - publishedLast) / statsInterval;
+			peakRate = std::max(peakRate, rate);
+			unsigned valid = 0;
+			for (const NodeModel &m : models) valid += m.absValid();
+			printf("%7.1f s  published %8.1f/s  received %8.1f/s  absValid %u/%u\n",
+				t / 1000.0, rate, (received - receivedLast) / statsInterval, valid, nodes);
+			fflush(stdout);
+			publishedLast = pub;
+			receivedLast = received;
+			tStats += (uint64_t)(statsInterval * 1000);
+		}
+		tNext = std::min(tNext, tStats);
+
+		t = millisNow() - t0;
+		if (!transport->poll(tNext > t ? (int)std::min<uint64_t>(tNext - t, 100) : 0, onMessage)) {
+			fprintf(stderr, "gasload: transport failed\n");
+			return 1;
+		}
+	}
+
+	double secs = (millisNow() - t0) / 1000.0;
+	uint64_t pub = published();
+	uint32_t requests = 0, lost = 0;
+	for (const NodeModel &m : models) {
+		requests += m.requests();
+		lost += m.lost();
+	}
+	if (options.log) fclose(options.log);
+	std::sort(latencies.begin(), latencies.end());
+	printf("# real time  %10.1f s, node time x%g\n", secs, speed);
+	printf("# published  %10llu  %10.1f/s, peak %.1f/s\n", (unsigned long long)pub, pub / secs, peakRate);
+	printf("# received   %10llu  %10.1f/s\n", (unsigned long long)received, received / secs);
+	printf("# requests   %10u\n", requests);
+	printf("# lost       %10u base counts, radio off or RX FIFO full\n", lost);
+	printf("# base count %10zu of %u nodes\n", latencies.size(), nodes);
+	if (!latencies.empty()) {
+		uint64_t sum = 0;
+		for (uint64_t l : latencies) sum += l;
+		printf("# latency    min %llu, avg %llu, p50 %llu, p95 %llu, max %llu ms\n",
+			(unsigned long long)latencies.front(), (unsigned long long)(sum / latencies.size()),
+			(unsigned long long)percentile(latencies, 50), (unsigned long long)percentile(latencies, 95),
+			(unsigned long long)latencies.back());
+	}
+	return latencies.size() == nodes ? 0 : 2;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file 		  modelcheck.cpp
+ *
+ * Project		: Home automation
+ * Author		: agent
+ * Created		: 16-Oct-2026
+ * Tabsize		: 4
+ *
+ * This Revision: $Id: $
+ */
+
+/*
+   Copyright (C) 2026 agent
+
+   This Source Code Form is subject to the terms of the Mozilla Public License, v. 2.0.
+   If a copy of the MPL was not distributed with this file, You can obtain one at http://mozilla.org/MPL/2.0/
+
+   SPDX-License-Identifier: MPL-2.0
+*/
+
+/**
+ * @brief Compares the messages of one gasload node with the simulation of
+ * the real firmware on the same trace, run with `make check`.
+ *
+ *     ./modelcheck SIM_OUTPUT GASLOAD_LOG DAYS
+ *
+ * SIM_OUTPUT is the output of the firmware simulation, with `TX` lines like
+ *   0d 01:00:00.100 TX 81/1/0/34 780
+ * GASLOAD_LOG is what `gasload --log` wrote for node 1, with lines like
+ *   1 3600.100 my/1/stat/1/81/1/0/34 780
+ * Presentations and the battery and internal messages are skipped, since
+ * the battery voltage of the model is fixed. All other messages must be
+ * the same, in the same order, within MAX_SKEW seconds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "NodeDefs.h"
+
+#define C_PRESENTATION	0
+#define NODE_SENSOR_ID	255
+
+/// max. difference in node time between the simulation and the model, in s
+#define MAX_SKEW		0.5
+
+struct Message {
+	double t;				///< node time in s
+	unsigned sensor;
+	unsigned command;
+	unsigned type;
+	std::string payload;
+};
+
+
+/// is the message compared at all?
+static bool compared( const Message &m )
+{
+	return m.command != C_PRESENTATION
+		&& m.sensor != SENSOR_ID_VCC && m.sensor != NODE_SENSOR_ID;
+}
+
+
+/// strip blanks and line end
+static std::string payloadOf( const char *s )
+{
+	std::string p(s ? s : "");
+	while (!p.empty() && p[0] == ' ') p.erase(0, 1);
+	while (!p.empty() && (p.back() == '\n' || p.back() == '\r' || p.back() == ' ')) p.pop_back();
+	return p;
+}
+
+
+/// TX lines of the firmware simulation
+static bool readSim( const char *path, std::vector<Message> &messages )
+{
+	FILE *f = fopen(path, "r");
+	if (!f) { perror(path); return false; }
+	char line[256];
+	while (fgets(line, sizeof line, f)) {
+		unsigned d, h, m, ack;
+		double s;
+		int n = 0;
+		Message msg;
+		if (sscanf(line, "%ud %u:%u:%lf TX %u/%u/%u/%u%n",
+				   &d, &h, &m, &s, &msg.sensor, &msg.command, &ack, &msg.type, &n) < 8 || !n)
+			continue;
+		msg.t = d * 86400.0 + h * 3600.0 + m * 60.0 + s;
+		msg.payload = payloadOf(line + n);
+		if (compared(msg)) messages.push_back(msg);
+	}
+	fclose(f);
+	return true;
+}
+
+
+/// messages of node 1 in a gasload log, sent before `until`
+static bool readLog( const char *path, double until, std::vector<Message> &messages )
+{
+	FILE *f = fopen(path, "r");
+	if (!f) { perror(path); return false; }
+	char line[256];
+	while (fgets(line, sizeof line, f)) {
+		unsigned node, ack;
+		int n = 0;
+		Message msg;
+		char topic[128];
+		if (sscanf(line, "%u %lf %127s%n", &node, &msg.t, topic, &n) < 3 || node != 1 || msg.t >= until)
+			continue;
+		// topic is <prefix>/<node>/<sensor>/<command>/<ack>/<type>, prefix may contain '/'
+		char *p = topic + strlen(topic);
+		for (int slashes = 0; p > topic && slashes < 5; ) if (*--p == '/') slashes++;
+		if (sscanf(p, "/%*u/%u/%u/%u/%u", &msg.sensor, &msg.command, &ack, &msg.type) < 4)
+			continue;
+		msg.payload = payloadOf(line + n);
+		if (compared(msg)) messages.push_back(msg);
+	}
+	fclose(f);
+	return true;
+}
+
+
+static void print( const char *who, const Message &m )
+{
+	printf("  %-8s %10.3f %u/%u/%u %s\n", who, m.t, m.sensor, m.command, m.type, m.payload.c_str());
+}
+
+
+int main( int argc, char *argv[] )
+{
+	if (argc != 4) {
+		fprintf(stderr, "usage: modelcheck SIM_OUTPUT GASLOAD_LOG DAYS\n");
+		return 2;
+	}
+	std::vector<Message> sim, model;
+	if (!readSim(argv[1], sim) || !readLog(argv[2], atof(argv[3]) * 86400, model)) return 2;
+
+	unsigned failures = 0;
+	double skew = 0;
+	size_t n = std::max(sim.size(), model.size());
+	for (size_t i = 0; i < n && failures < 10; i++) {
+		if (i >= sim.size() || i >= model.size()) {
+			printf("message %zu: only in %s\n", i, i >= sim.size() ? "gasload" : "firmware");
+			if (i < sim.size()) print("firmware", sim[i]);
+			if (i < model.size()) print("gasload", model[i]);
+			failures++;
+			continue;
+		}
+		const Message &a = sim[i], &b = model[i];
+		double dt = fabs(a.t - b.t);
+		if (a.sensor != b.sensor || a.command != b.command || a.type != b.type
+			|| a.payload != b.payload || dt > MAX_SKEW) {
+			printf("message %zu differs:\n", i);
+			print("firmware", a);
+			print("gasload", b);
+			failures++;
+		}
+		if (dt > skew) skew = dt;
+	}
+	printf("%zu messages from the firmware, %zu from gasload, max. time difference %.3f s\n",
+		   sim.size(), model.size(), skew);
+	if (failures) {
+		printf("FAILED\n");
+		return 1;
+	}
+	return 0;
+}
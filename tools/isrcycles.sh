@@ -0,0 +1,108 @@
+#!/bin/sh
+# Instructions and CPU cycles of the Timer2 ISR, counted in the disassembly
+# of the firmware, with the functions it calls, e.g. before and after the
+# ISR was inlined:
+#   tools/isrcycles.sh --rev <revision before> 'XtalTimer::tick()' 'myISR()' 'Button::tick'
+#   tools/isrcycles.sh
+# Arguments are functions to count in addition to __vector_7 (TIMER2_COMPA),
+# as demangled by avr-objdump -C; a name ending in ')' must match exactly,
+# others match every function whose name starts with it. Calls through a
+# function pointer (icall) can't be followed, so name the callback. PIOENV
+# selects the PlatformIO environment (default 126), and with --rev, an
+# earlier revision is built in a temporary git worktree, as with
+# tools/envsizes.sh.
+#
+# Each instruction is counted once, branches and skips as not taken, so
+# the cycles are those of the straight path through all listed code, plus
+# 7 cycles to enter the interrupt and jump from the vector table. The
+# second table splits the ISR into the prologue avr-gcc puts in front of
+# it (saving r0, r1, SREG and the registers used), the epilogue restoring
+# them, with reti, and the body in between, including the listed functions.
+
+cd "$(dirname "$0")/.." || exit 1
+AVR_OBJDUMP=${AVR_OBJDUMP:-$HOME/.platformio/packages/toolchain-atmelavr/bin/avr-objdump}
+[ -x "$AVR_OBJDUMP" ] || AVR_OBJDUMP=avr-objdump
+PIOENV=${PIOENV:-126}
+
+REV=
+if [ "$1" = "--rev" ]; then
+	REV=$2
+	shift 2
+fi
+
+if [ -n "$REV" ]; then
+	TREE=$(mktemp -d) || exit 1
+	git worktree add -q --detach "$TREE" "$REV" || exit 1
+	trap 'git worktree remove --force "$TREE"' EXIT
+	echo "# revision: $(git log -1 --format='%h %s' "$REV")"
+	cd "$TREE" || exit 1
+fi
+
+if ! pio run -s -e "$PIOENV" >/dev/null 2>&1; then
+	echo "isrcycles: build of $PIOENV failed" >&2
+	exit 1
+fi
+
+"$AVR_OBJDUMP" -d -C ".pio/build/$PIOENV/firmware.elf" | awk -v names="__vector_7|$(IFS='|'; echo "$*")" '
+	BEGIN {
+		n = split(names, want, "|")
+		# ATmega328P cycles, branches and skips not taken
+		split("push pop ld ldd st std lds sts adiw sbiw mul muls mulsu fmul cbi sbi rjmp ijmp", c2, " ")
+		for (i in c2) cyc[c2[i]] = 2
+		cyc["lpm"] = 3; cyc["jmp"] = 3; cyc["rcall"] = 3; cyc["icall"] = 3
+		cyc["call"] = 4; cyc["ret"] = 4; cyc["reti"] = 4
+		printf "%-32s %6s %6s %6s %6s %6s\n", "function", "instr", "push", "pop", "calls", "cycles"
+	}
+	/^[0-9a-f]+ <.*>:$/ {
+		fn = $0; sub(/^[0-9a-f]+ </, "", fn); sub(/>:$/, "", fn)
+		counting = 0
+		for (i = 1; i <= n; i++) {
+			w = want[i]
+			if (w == "") continue
+			if ((w ~ /\)$/) ? (fn == w) : (index(fn, w) == 1)) counting = 1
+		}
+		if (counting) order[++nfn] = fn
+		next
+	}
+	counting && /^ *[0-9a-f]+:\t/ {
+		split($0, f, "\t")
+		op = f[3]; sub(/ .*/, "", op)
+		if (op == "" || op == ".word") next
+		instr[fn]++
+		if (fn == "__vector_7") { isr[++nisr] = op; arg[nisr] = f[4] }
+		cycles[fn] += (op in cyc) ? cyc[op] : 1
+		if (op == "push") push[fn]++
+		if (op == "pop") pop[fn]++
+		if (op == "call" || op == "rcall" || op == "icall") calls[fn]++
+	}
+	END {
+		for (i = 1; i <= nfn; i++) {
+			fn = order[i]
+			printf "%-32s %6d %6d %6d %6d %6d\n", fn, instr[fn], push[fn], pop[fn], calls[fn], cycles[fn]
+			ti += instr[fn]; tp += push[fn]; to += pop[fn]; tc += calls[fn]; ty += cycles[fn]
+		}
+		printf "%-32s %6d %6d %6d %6d %6d\n", "total, +7 to enter", ti, tp, to, tc, ty + 7
+
+		# prologue: push, and r0 = SREG, r1 = 0 in between; epilogue: pop,
+		# SREG restored, reti
+		for (i = 1; i <= nisr; i++) {
+			op = isr[i]
+			if (!(op == "push" || (op == "in" && arg[i] ~ /0x3f/) || ((op == "eor" || op == "clr") && arg[i] ~ /^r1(,|$)/))) break
+			pro = i
+		}
+		for (i = nisr; i > pro; i--) {
+			op = isr[i]
+			if (!(op == "pop" || op == "reti" || (op == "out" && arg[i] ~ /^0x3f/))) break
+			epi = i
+		}
+		if (!epi) epi = nisr + 1
+		for (i = 1; i <= nisr; i++) {
+			c = (isr[i] in cyc) ? cyc[isr[i]] : 1
+			if (i <= pro) pc += c; else if (i >= epi) ec += c
+		}
+		printf "\n%-32s %6s %6s\n", "__vector_7", "instr", "cycles"
+		printf "%-32s %6s %6d\n", "enter", "", 7
+		printf "%-32s %6d %6d\n", "prologue", pro, pc
+		printf "%-32s %6d %6d\n", "body, with listed functions", ti - pro - (nisr - epi + 1), ty - pc - ec
+		printf "%-32s %6d %6d\n", "epilogue", nisr - epi + 1, ec
+	}'